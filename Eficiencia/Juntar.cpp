@@ -1,3 +1,4 @@
+//batch_plots.cpp draws this comparison for every quantity and Muon Id in one run
 #include <stdio.h>
 #include <TFile.h>
 #include <TLorentzVector.h>
@@ -0,0 +1,176 @@
+//Proposes bin edges where every bin (or cell, in 2D) reaches a target of statistics
+//Probes are counted once on a fine grid (src/cut_and_count.h) and fine bins are merged along each axis until every bin reaches the target
+//The edges are written to a bins file that efficiency.cpp, plot_sys_efficiency.cpp and plot_sys_efficiency_2d.cpp read with bins_file
+//Usage: root -l -b -q adaptive_binning.cpp
+//Change if you need
+#include "src/dofits/DoFit_Jpsi_Run.h"
+//#include "src/dofits/DoFit_Jpsi_MC.h"
+
+#include "src/create_folder.h"
+#include "src/cut_and_count.h"
+#include "src/bin_edges.h"
+
+//Which Muon Id do you want to study?
+string MuonId   = "trackerMuon";
+
+//Range of each quantity. Leave yquantity empty for 1D. In 2D the y axis is absolute, as in plot_sys_efficiency_2d.cpp
+string xquantity = "Pt";    double xrange[] = {0.0, 40.};
+string yquantity = "";      double yrange[] = {0.0, 2.4};
+//string yquantity = "Eta";   double yrange[] = {0.0, 2.4};
+
+//Edges are chosen among the edges of a uniform grid with this number of bins on each axis
+int fine_bins = 400;
+
+//"yield": sideband subtracted signal of ALL probes on every bin is at least target
+//"precision": error of the sideband subtracted efficiency on every bin is at most target
+string criterion = "yield";     double target = 2000.;
+//string criterion = "precision"; double target = 0.01;
+
+//Maximum number of bins on each axis. The target is made stricter until the edges fit on it
+int max_bins = 20;
+
+string bins_folder = "results/bins/";
+
+//True if the counts of a bin reach the target. scale > 1 makes it stricter
+bool bin_reaches_target(const SidebandCounts& counts, double scale)
+{
+	if (criterion == "yield")
+	{
+		double signal, error;
+		sideband_subtraction(counts.n[0], signal, error);
+		return signal >= target*scale;
+	}
+
+	double efficiency, error;
+	sideband_efficiency(counts, efficiency, error);
+	return error > 0. && error <= target/scale;
+}
+
+//Merges fine bins along one axis. A bin ends when it reaches the target on every group of fine bins of the other axis
+//Returns the fine bin indices where bins start and end. What is left at the end joins the last bin
+vector<int> merge_axis(const vector<SidebandCounts>& fine, bool along_x, const vector<int>& other_groups, double scale)
+{
+	int ngroups = other_groups.size() - 1;
+	vector<int> ends = {0};
+	vector<SidebandCounts> merged(ngroups, SidebandCounts{});
+
+	for (int k = 0; k < fine_bins; k++)
+	{
+		bool all_reach = true;
+		for (int g = 0; g < ngroups; g++)
+		{
+			for (int m = other_groups[g]; m < other_groups[g+1]; m++)
+			{
+				const SidebandCounts& cell = along_x ? fine[k*(other_groups.back()) + m] : fine[m*fine_bins + k];
+				for (int sample = 0; sample < 2; sample++)
+					for (int region = 0; region < 3; region++)
+						merged[g].n[sample][region] += cell.n[sample][region];
+			}
+			all_reach = all_reach && bin_reaches_target(merged[g], scale);
+		}
+
+		if (all_reach)
+		{
+			ends.push_back(k+1);
+			merged.assign(ngroups, SidebandCounts{});
+		}
+	}
+
+	if (ends.size() == 1)
+		ends.push_back(fine_bins);
+	else
+		ends.back() = fine_bins;
+	return ends;
+}
+
+//Merges along one axis, making the target stricter until there are at most max_bins
+vector<int> merge_axis_limited(const vector<SidebandCounts>& fine, bool along_x, const vector<int>& other_groups)
+{
+	double scale = 1.;
+	vector<int> ends = merge_axis(fine, along_x, other_groups, scale);
+	while ((int)ends.size() - 1 > max_bins)
+	{
+		scale *= 1.1;
+		ends = merge_axis(fine, along_x, other_groups, scale);
+	}
+	return ends;
+}
+
+vector<double> fine_to_edges(const vector<int>& ends, const double* range)
+{
+	vector<double> edges;
+	for (int end : ends)
+		edges.push_back(range[0] + (range[1] - range[0])*end/fine_bins);
+	return edges;
+}
+
+void adaptive_binning()
+{
+	bool is_2d = (yquantity != "");
+
+	vector<double> xfine, yfine;
+	for (int k = 0; k <= fine_bins; k++)
+	{
+		xfine.push_back(xrange[0] + (xrange[1] - xrange[0])*k/fine_bins);
+		yfine.push_back(yrange[0] + (yrange[1] - yrange[0])*k/fine_bins);
+	}
+
+	TStopwatch watch;
+	vector<SidebandCounts> fine = count_on_grid(data_file_path, MuonId, xquantity, xfine, yquantity, yfine, true);
+	double count_time = watch.RealTime();
+
+	//In 2D the edges of each axis depend on the other one, so both are merged a few times
+	int nfiney = is_2d ? fine_bins : 1;
+	vector<int> xends = {0, fine_bins};
+	vector<int> yends = {0, nfiney};
+	for (int iteration = 0; iteration < (is_2d ? 3 : 1); iteration++)
+	{
+		if (is_2d)
+			yends = merge_axis_limited(fine, false, xends);
+		xends = merge_axis_limited(fine, true, yends);
+	}
+
+	vector<double> xedges = fine_to_edges(xends, xrange);
+	vector<double> yedges = fine_to_edges(yends, yrange);
+
+	//Statistics of every proposed bin
+	vector<SidebandCounts> proposed = count_on_grid(data_file_path, MuonId, xquantity, xedges, yquantity, yedges, true);
+	int nbinsx = xedges.size() - 1;
+	int nbinsy = is_2d ? yedges.size() - 1 : 1;
+
+	printf("\n%-24s %-24s %12s %12s %12s\n", xquantity.c_str(), is_2d ? ("|" + yquantity + "|").c_str() : "", "signal all", "efficiency", "error");
+	for (int i = 0; i < nbinsx; i++)
+		for (int j = 0; j < nbinsy; j++)
+		{
+			double signal, signal_error, efficiency, error;
+			sideband_subtraction(proposed[i*nbinsy + j].n[0], signal, signal_error);
+			sideband_efficiency (proposed[i*nbinsy + j], efficiency, error);
+
+			string xbin = "[" + to_string(xedges[i]) + ", " + to_string(xedges[i+1]) + ")";
+			string ybin = is_2d ? "[" + to_string(yedges[j]) + ", " + to_string(yedges[j+1]) + ")" : "";
+			printf("%-24s %-24s %12.0f %12.4f %12.4f\n", xbin.c_str(), ybin.c_str(), signal, efficiency, error);
+		}
+
+	create_folder(bins_folder.c_str());
+	string file_path = bins_folder + output_folder_name + "_" + MuonId + "_" + xquantity + (is_2d ? "_" + yquantity : "") + ".txt";
+	string comment = string("adaptive_binning.cpp: ") + output_folder_name + " " + MuonId + ", " + criterion + " target " + to_string(target)
+		+ ", at most " + to_string(max_bins) + " bins per axis" + (is_2d ? ", y axis is absolute" : "");
+
+	vector<string>         quantities = {xquantity};
+	vector<vector<double>> edges      = {xedges};
+	if (is_2d)
+	{
+		quantities.push_back(yquantity);
+		edges.push_back(yedges);
+	}
+	if (!write_bins(file_path, comment, quantities, edges))
+		abort();
+
+	cout << "\n------------------------\n";
+	cout << "Counted " << fine_bins << (is_2d ? "x" + to_string(fine_bins) : "") << " fine bins in " << count_time << "s\n";
+	cout << nbinsx << " bins of " << xquantity;
+	if (is_2d)
+		cout << " and " << nbinsy << " bins of |" << yquantity << "|";
+	cout << "\nOutput: " << file_path;
+	cout << "\n------------------------\n";
+}
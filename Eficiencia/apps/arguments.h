@@ -0,0 +1,134 @@
+#ifndef ARGUMENTS_HEADER
+#define ARGUMENTS_HEADER
+//Command line of the compiled executables: options as "--name value", flags as "--name" and the rest as positional arguments
+#include "../src/root_headers.h"
+
+struct Arguments
+{
+	string              usage;
+	map<string, string> options;
+	vector<string>      positional;
+};
+
+void print_usage(const Arguments& args)
+{
+	cout << args.usage;
+}
+
+//flags are the options without value
+Arguments parse_arguments(int argc, char** argv, string usage, const vector<string>& flags)
+{
+	Arguments args;
+	args.usage = usage;
+	for (int i = 1; i < argc; i++)
+	{
+		string argument = argv[i];
+		if (argument == "-h" || argument == "--help")
+		{
+			print_usage(args);
+			exit(0);
+		}
+
+		if (argument.substr(0, 2) != "--")
+		{
+			args.positional.push_back(argument);
+			continue;
+		}
+
+		string name = argument.substr(2);
+		if (find(flags.begin(), flags.end(), name) != flags.end())
+			args.options[name] = "1";
+		else if (i + 1 < argc)
+			args.options[name] = argv[++i];
+		else
+		{
+			cerr << "Option " << argument << " needs a value\n";
+			print_usage(args);
+			exit(1);
+		}
+	}
+	return args;
+}
+
+//Each read_option returns true and sets value if the option was given
+bool read_option(Arguments& args, string name, string& value)
+{
+	auto found = args.options.find(name);
+	if (found == args.options.end())
+		return false;
+
+	value = found->second;
+	args.options.erase(found);
+	return true;
+}
+
+bool read_option(Arguments& args, string name, bool& value)
+{
+	string text;
+	if (!read_option(args, name, text))
+		return false;
+
+	value = (text == "1" || text == "true" || text == "yes");
+	return true;
+}
+
+bool read_option(Arguments& args, string name, int& value)
+{
+	string text;
+	if (!read_option(args, name, text))
+		return false;
+
+	value = atoi(text.c_str());
+	return true;
+}
+
+bool read_option(Arguments& args, string name, double& value)
+{
+	string text;
+	if (!read_option(args, name, text))
+		return false;
+
+	value = atof(text.c_str());
+	return true;
+}
+
+//Comma separated list, like "trackerMuon,globalMuon"
+bool read_option(Arguments& args, string name, vector<string>& values)
+{
+	string text;
+	if (!read_option(args, name, text))
+		return false;
+
+	values.clear();
+	stringstream items(text);
+	string item;
+	while (getline(items, item, ','))
+		values.push_back(item);
+	return true;
+}
+
+//Comma separated edges, like "0,3.4,4,5,40"
+bool read_option(Arguments& args, string name, vector<double>& values)
+{
+	vector<string> items;
+	if (!read_option(args, name, items))
+		return false;
+
+	values.clear();
+	for (string item : items)
+		values.push_back(atof(item.c_str()));
+	return true;
+}
+
+//Aborts if there is an option nobody read, so typos are not silently ignored
+void check_unused_options(const Arguments& args)
+{
+	if (args.options.empty())
+		return;
+
+	for (auto& option : args.options)
+		cerr << "Unknown option --" << option.first << "\n";
+	print_usage(args);
+	exit(1);
+}
+#endif
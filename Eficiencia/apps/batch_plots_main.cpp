@@ -0,0 +1,40 @@
+//Compiled batch_plots.cpp: every overlay and data/MC ratio of the efficiencies in one run
+#include "arguments.h"
+#include "../src/batch_plots.h"
+
+int main(int argc, char** argv)
+{
+	string usage =
+		"Usage: batch_plots [options]\n"
+		"  --kind NAME            efficiency, systematic_1D or systematic_2D (default efficiency)\n"
+		"  --datasets NAMES       comma separated datasets of the results store, the first is the reference of the ratios\n"
+		"                         (default Jpsi_Run_2011,Jpsi_MC_2020)\n"
+		"  --quantity NAMES       comma separated quantities, Eta_Pt on 2D (default Pt,Eta,Phi)\n"
+		"  --muon-id IDS          comma separated Muon Ids (default trackerMuon,standaloneMuon,globalMuon)\n"
+		"  --variations NAMES     comma separated efficiencies of each run: Nominal, Final, Systematic or a variation (default Nominal)\n"
+		"  --store PATH           results store (default " + results_store_path + ")\n"
+		"  --output-folder PATH   where the png files are saved, in a folder by kind (default results/comparisons/)\n"
+		"  --workers N            processes drawing the plots (default 4)\n";
+
+	Arguments args = parse_arguments(argc, argv, usage, {});
+
+	string         kind          = "efficiency";
+	vector<string> datasets      = {"Jpsi_Run_2011", "Jpsi_MC_2020"};
+	vector<string> quantities    = {"Pt", "Eta", "Phi"};
+	vector<string> muon_ids      = {"trackerMuon", "standaloneMuon", "globalMuon"};
+	vector<string> variations    = {"Nominal"};
+	string         output_folder = "results/comparisons/";
+	int            nworkers      = 4;
+	read_option(args, "kind",          kind);
+	read_option(args, "datasets",      datasets);
+	read_option(args, "quantity",      quantities);
+	read_option(args, "muon-id",       muon_ids);
+	read_option(args, "variations",    variations);
+	read_option(args, "output-folder", output_folder);
+	read_option(args, "workers",       nworkers);
+	read_option(args, "store",         results_store_path);
+	check_unused_options(args);
+
+	batch_plots(kind, datasets, quantities, muon_ids, variations, output_folder, nworkers);
+	return 0;
+}
@@ -0,0 +1,43 @@
+//Compiled benchmark_fit_backends.cpp: times every likelihood backend on the same bins, without the interpreter
+#include "fit_settings.h"
+
+//Settings of benchmark_fit_backends.cpp
+extern string         MuonId;
+extern string         quantity;
+extern vector<double> bins;
+
+void benchmark_fit_backends();
+
+int main(int argc, char** argv)
+{
+	//Backends, fit bins, cache and plots are set by the benchmark, so only the data and the bins are options
+	string usage =
+		"Usage: benchmark_fit_backends [options]\n"
+		"  --muon-id ID           Muon Id of the fits: trackerMuon, standaloneMuon or globalMuon\n"
+		"  --quantity NAME        Pt, Eta or Phi (with --bins)\n"
+		"  --bins EDGES           comma separated bin edges\n"
+		"  --data PATH            input file, glob pattern, comma separated files or .txt list\n"
+		"  --output-folder NAME   name of the dataset on the record, like Jpsi_MC_2020\n"
+		"  --tag-cut EXPRESSION   selection of the tag muon\n"
+		"  --model NAME           model of the fits, like GaussCB or 2xGauss (src/dofits/fit_models.h)\n"
+		"  --mass-min VALUE --mass-max VALUE\n"
+		"  --threads N            threads reading and selecting the input files (0 uses every core)\n";
+
+	Arguments args = parse_arguments(argc, argv, usage, {});
+
+	read_option(args, "muon-id",  MuonId);
+	read_option(args, "quantity", quantity);
+	read_option(args, "bins",     bins);
+	if (read_option(args, "data",          data_file_option))     data_file_path     = data_file_option.c_str();
+	if (read_option(args, "output-folder", output_folder_option)) output_folder_name = output_folder_option.c_str();
+	if (read_option(args, "tag-cut",       tag_cut_option))       tag_cut            = tag_cut_option.c_str();
+	read_option(args, "model",    fit_model);
+	read_option(args, "mass-min", _mmin);
+	read_option(args, "mass-max", _mmax);
+	read_option(args, "threads",  data_threads);
+	check_unused_options(args);
+
+	gROOT->SetBatch(true);
+	benchmark_fit_backends();
+	return 0;
+}
@@ -0,0 +1,30 @@
+//Compiled compare_efficiency: plots the same efficiency of two files written by efficiency.cpp
+#include "arguments.h"
+#include "../src/compare_efficiency.h"
+
+int main(int argc, char** argv)
+{
+	string usage =
+		"Usage: compare [--muon-id IDS] [--quantity NAME] FILE0 FILE1\n"
+		"  --muon-id IDS          comma separated Muon Ids, one plot each (default trackerMuon)\n"
+		"  --quantity NAME        Pt, Eta or Phi (default Pt)\n";
+
+	Arguments args = parse_arguments(argc, argv, usage, {});
+
+	vector<string> muon_ids = {"trackerMuon"};
+	string quantity = "Pt";
+	read_option(args, "muon-id",  muon_ids);
+	read_option(args, "quantity", quantity);
+	check_unused_options(args);
+
+	if (args.positional.size() != 2)
+	{
+		print_usage(args);
+		return 1;
+	}
+
+	gROOT->SetBatch(true);
+	for (string muon_id : muon_ids)
+		compare_efficiency(muon_id, quantity, args.positional[0], args.positional[1]);
+	return 0;
+}
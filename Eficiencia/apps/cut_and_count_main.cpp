@@ -0,0 +1,41 @@
+//Compiled cut_and_count.cpp: efficiency by sideband subtraction, compared with the fits of efficiency.cpp
+#include "fit_settings.h"
+
+//Settings of cut_and_count.cpp
+extern string         MuonId;
+extern string         quantity;
+extern vector<double> bins;
+extern string         bins_file;
+extern double         flag_threshold;
+
+void cut_and_count();
+
+int main(int argc, char** argv)
+{
+	string usage =
+		"Usage: cut_and_count [options]\n"
+		"  --muon-id IDS          comma separated Muon Ids, every one is a run: trackerMuon,standaloneMuon,globalMuon\n"
+		"  --quantity NAME        Pt, Eta or Phi (with --bins or --bins-file)\n"
+		"  --bins EDGES           comma separated bin edges\n"
+		"  --bins-file PATH       bins file of adaptive_binning.cpp\n"
+		"  --threshold VALUE      bins that differ more than this from the fit are listed (default 0.02)\n"
+		+ fit_settings_usage;
+
+	Arguments args = parse_arguments(argc, argv, usage, fit_settings_flags);
+
+	vector<string> muon_ids = {MuonId};
+	read_option(args, "muon-id",   muon_ids);
+	read_option(args, "quantity",  quantity);
+	read_option(args, "bins",      bins);
+	read_option(args, "bins-file", bins_file);
+	read_option(args, "threshold", flag_threshold);
+	read_fit_settings(args);
+	check_unused_options(args);
+
+	for (string muon_id : muon_ids)
+	{
+		MuonId = muon_id;
+		cut_and_count();
+	}
+	return 0;
+}
@@ -0,0 +1,46 @@
+//Compiled efficiency.cpp. Settings of the macro are options here, so a scan does not need to edit it
+#include "fit_settings.h"
+
+//Settings of efficiency.cpp
+extern string         MuonId;
+extern string         quantity;
+extern vector<double> bins;
+extern string         bins_file;
+extern bool           incremental;
+extern string         prefix_file_name;
+
+void efficiency();
+
+int main(int argc, char** argv)
+{
+	string usage =
+		"Usage: efficiency [options]\n"
+		"  --muon-id IDS          comma separated Muon Ids, every one is a run: trackerMuon,standaloneMuon,globalMuon\n"
+		"  --quantity NAME        Pt, Eta or Phi (with --bins or --bins-file)\n"
+		"  --bins EDGES           comma separated bin edges\n"
+		"  --bins-file PATH       bins file of adaptive_binning.cpp\n"
+		"  --prefix TEXT          prefix of the output file name\n"
+		"  --incremental          only reads files added to the input since the last run\n"
+		+ fit_settings_usage;
+
+	vector<string> flags = fit_settings_flags;
+	flags.push_back("incremental");
+	Arguments args = parse_arguments(argc, argv, usage, flags);
+
+	vector<string> muon_ids = {MuonId};
+	read_option(args, "muon-id",     muon_ids);
+	read_option(args, "quantity",    quantity);
+	read_option(args, "bins",        bins);
+	read_option(args, "bins-file",   bins_file);
+	read_option(args, "prefix",      prefix_file_name);
+	read_option(args, "incremental", incremental);
+	read_fit_settings(args);
+	check_unused_options(args);
+
+	for (string muon_id : muon_ids)
+	{
+		MuonId = muon_id;
+		efficiency();
+	}
+	return 0;
+}
@@ -0,0 +1,65 @@
+#ifndef FIT_SETTINGS_HEADER
+#define FIT_SETTINGS_HEADER
+//Settings of the DoFit headers and of the fit pipeline, defined by the macro compiled with the executable
+#include "arguments.h"
+
+extern const char* output_folder_name;
+extern const char* data_file_path;
+extern const char* tag_cut;
+extern double      _mmin;
+extern double      _mmax;
+extern double      fit_bins;
+extern string      fit_model;
+extern string      fit_backend;
+extern string      fit_plot_mode;
+extern bool        use_fit_cache;
+extern int         data_threads;
+extern bool        print_memory;
+extern double      memory_limit;
+extern int         toys_per_bin;
+extern string      toy_mode;
+
+string fit_settings_usage =
+	"Fit options:\n"
+	"  --data PATH            input file, glob pattern, comma separated files or .txt list\n"
+	"  --output-folder NAME   name of the dataset on the output folders, like Jpsi_MC_2020\n"
+	"  --tag-cut EXPRESSION   selection of the tag muon\n"
+	"  --model NAME           model of the fits, like GaussCB, 2xGauss, DSCB or GaussCB_Chebychev (src/dofits/fit_models.h)\n"
+	"  --mass-min VALUE --mass-max VALUE --fit-bins N\n"
+	"  --backend roofit|fast  --plots deferred|inline|none  --no-cache\n"
+	"                         fast only fits models validated on the dataset by validate_fast_fit.cpp\n"
+	"  --threads N            threads reading and selecting the input files (0 uses every core)\n"
+	"  --toys N               bootstrap or toy fits of the nominal fit of every bin with the fast likelihood  --toy-mode bootstrap|toys\n"
+	"  --memory-limit MB      releases loaded data above this resident memory  --print-memory\n";
+
+vector<string> fit_settings_flags = {"no-cache", "print-memory"};
+
+//Strings behind the const char* settings, alive until the end of the program
+string data_file_option, output_folder_option, tag_cut_option;
+
+void read_fit_settings(Arguments& args)
+{
+	if (read_option(args, "data",          data_file_option))     data_file_path     = data_file_option.c_str();
+	if (read_option(args, "output-folder", output_folder_option)) output_folder_name = output_folder_option.c_str();
+	if (read_option(args, "tag-cut",       tag_cut_option))       tag_cut            = tag_cut_option.c_str();
+
+	read_option(args, "model",        fit_model);
+	read_option(args, "mass-min",     _mmin);
+	read_option(args, "mass-max",     _mmax);
+	read_option(args, "fit-bins",     fit_bins);
+	read_option(args, "backend",      fit_backend);
+	read_option(args, "plots",        fit_plot_mode);
+	read_option(args, "threads",      data_threads);
+	read_option(args, "toys",         toys_per_bin);
+	read_option(args, "toy-mode",     toy_mode);
+	read_option(args, "memory-limit", memory_limit);
+	read_option(args, "print-memory", print_memory);
+
+	bool no_cache = false;
+	if (read_option(args, "no-cache", no_cache))
+		use_fit_cache = !no_cache;
+
+	//Canvases are only saved, never shown
+	gROOT->SetBatch(true);
+}
+#endif
@@ -0,0 +1,37 @@
+//Compiled query_results.cpp: runs of an efficiency on the results store and the bins of one of them
+#include "arguments.h"
+
+extern string results_store_path;
+
+void query_results(string dataset, string MuonId, string quantity, string variation, int run, string path);
+
+int main(int argc, char** argv)
+{
+	string usage =
+		"Usage: query_results [options]\n"
+		"  --dataset NAME         name of the dataset on the output folders (default Jpsi_Run_2011)\n"
+		"  --muon-id ID           trackerMuon, standaloneMuon or globalMuon (default trackerMuon)\n"
+		"  --quantity NAME        Pt, Eta, Phi or Eta_Pt (default Pt)\n"
+		"  --variation NAME       Nominal, Final, Systematic or a variation (default Nominal)\n"
+		"  --run N                run whose bins are shown, 0 for the last one (default 0)\n"
+		"  --store PATH           results store (default " + results_store_path + ")\n";
+
+	Arguments args = parse_arguments(argc, argv, usage, {});
+
+	string dataset   = "Jpsi_Run_2011";
+	string MuonId    = "trackerMuon";
+	string quantity  = "Pt";
+	string variation = "Nominal";
+	int    run       = 0;
+	string path      = results_store_path;
+	read_option(args, "dataset",   dataset);
+	read_option(args, "muon-id",   MuonId);
+	read_option(args, "quantity",  quantity);
+	read_option(args, "variation", variation);
+	read_option(args, "run",       run);
+	read_option(args, "store",     path);
+	check_unused_options(args);
+
+	query_results(dataset, MuonId, quantity, variation, run, path);
+	return 0;
+}
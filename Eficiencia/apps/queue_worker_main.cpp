@@ -0,0 +1,38 @@
+//Compiled queue_worker.cpp: runs tasks of a work queue until there is nothing left to claim
+//Tasks carry their data, tag cut and fit settings, so only how this worker runs can be chosen here
+#include "arguments.h"
+
+extern string fit_backend;
+extern int    data_threads;
+extern bool   print_memory;
+extern double memory_limit;
+extern int    claim_heartbeat_seconds;
+
+void queue_worker(string queue);
+
+int main(int argc, char** argv)
+{
+	string usage =
+		"Usage: queue_worker [options] QUEUE\n"
+		"  --backend roofit|fast  fit backend (fast only for models validated by validate_fast_fit.cpp)\n"
+		"  --threads N            threads reading and selecting the input files (0 uses every core)\n"
+		"  --heartbeat SECONDS    seconds between refreshes of the claim of the running task\n"
+		"  --memory-limit MB      releases loaded data above this resident memory  --print-memory\n";
+
+	Arguments args = parse_arguments(argc, argv, usage, {"print-memory"});
+	read_option(args, "backend",      fit_backend);
+	read_option(args, "threads",      data_threads);
+	read_option(args, "heartbeat",    claim_heartbeat_seconds);
+	read_option(args, "memory-limit", memory_limit);
+	read_option(args, "print-memory", print_memory);
+	check_unused_options(args);
+
+	if (args.positional.size() != 1)
+	{
+		print_usage(args);
+		return 1;
+	}
+
+	queue_worker(args.positional[0]);
+	return 0;
+}
@@ -0,0 +1,33 @@
+//Compiled render_fits.cpp: draws the fits saved with --plots deferred
+#include "arguments.h"
+
+void render_fits(string folder, bool only_failed, int nworkers);
+
+int main(int argc, char** argv)
+{
+	string usage =
+		"Usage: render_fits [options] [FOLDER]\n"
+		"  FOLDER                 folder of the fit snapshots (default results/bins_fit/efficiency/)\n"
+		"  --only-failed          only draws the fits that did not converge\n"
+		"  --workers N            processes drawing the fits (default 4)\n";
+
+	Arguments args = parse_arguments(argc, argv, usage, {"only-failed"});
+
+	string folder      = "results/bins_fit/efficiency/";
+	bool   only_failed = false;
+	int    nworkers    = 4;
+	read_option(args, "only-failed", only_failed);
+	read_option(args, "workers",     nworkers);
+	check_unused_options(args);
+
+	if (args.positional.size() > 1)
+	{
+		print_usage(args);
+		return 1;
+	}
+	if (args.positional.size() == 1)
+		folder = args.positional[0];
+
+	render_fits(folder, only_failed, nworkers);
+	return 0;
+}
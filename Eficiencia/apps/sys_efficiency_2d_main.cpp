@@ -0,0 +1,60 @@
+//Compiled plot_sys_efficiency_2d.cpp
+#include "fit_settings.h"
+
+//Settings of plot_sys_efficiency_2d.cpp
+extern string         MuonId;
+extern string         xquantity;
+extern vector<double> xbins;
+extern string         yquantity;
+extern vector<double> ybins;
+extern string         bins_file;
+extern bool           use_warm_start;
+extern bool           resume;
+extern string         run_mode;
+extern string         queue_folder;
+extern int            variation_workers;
+
+void plot_sys_efficiency_2d();
+
+int main(int argc, char** argv)
+{
+	string usage =
+		"Usage: sys_efficiency_2d [options]\n"
+		"  --muon-id IDS          comma separated Muon Ids, every one is a run: trackerMuon,standaloneMuon,globalMuon\n"
+		"  --xquantity NAME --xbins EDGES\n"
+		"  --yquantity NAME --ybins EDGES\n"
+		"  --bins-file PATH       bins file of adaptive_binning.cpp\n"
+		"  --cold-start           does not seed the variations with the nominal fit\n"
+		"  --resume               skips the fits stored on the checkpoint of a previous run\n"
+		"  --queue FOLDER         fits as tasks of a work queue on FOLDER, shared with queue_worker\n"
+		"  --workers N            processes fitting bins at the same time\n"
+		+ fit_settings_usage;
+
+	vector<string> flags = fit_settings_flags;
+	flags.insert(flags.end(), {"cold-start", "resume"});
+	Arguments args = parse_arguments(argc, argv, usage, flags);
+
+	vector<string> muon_ids = {MuonId};
+	bool cold_start = false;
+	read_option(args, "muon-id",    muon_ids);
+	read_option(args, "xquantity",  xquantity);
+	read_option(args, "xbins",      xbins);
+	read_option(args, "yquantity",  yquantity);
+	read_option(args, "ybins",      ybins);
+	read_option(args, "bins-file",  bins_file);
+	read_option(args, "resume",     resume);
+	read_option(args, "workers",    variation_workers);
+	if (read_option(args, "cold-start", cold_start))
+		use_warm_start = !cold_start;
+	if (read_option(args, "queue", queue_folder))
+		run_mode = "queue";
+	read_fit_settings(args);
+	check_unused_options(args);
+
+	for (string muon_id : muon_ids)
+	{
+		MuonId = muon_id;
+		plot_sys_efficiency_2d();
+	}
+	return 0;
+}
@@ -0,0 +1,23 @@
+//Every overlay and data/MC ratio of the efficiencies in one run (see src/batch_plots.h)
+//Usage: root -l -b -q 'batch_plots.cpp("systematic_1D")'
+#include "src/root_headers.h"
+#include "src/batch_plots.h"
+
+//Datasets to compare (output_folder_name of their runs on the results store). The first one is the reference of the ratios
+vector<string> datasets = {"Jpsi_Run_2011", "Jpsi_MC_2020"};
+
+vector<string> quantities = {"Pt", "Eta", "Phi"};
+//vector<string> quantities = {"Eta_Pt"};
+
+vector<string> muon_ids = {"trackerMuon", "standaloneMuon", "globalMuon"};
+
+//Efficiencies of each run. efficiency.cpp only has "Nominal"
+//plot_sys_efficiency.cpp has "Final" and the names of src/variations.h, plot_sys_efficiency_2d.cpp has "Systematic" too
+vector<string> efficiency_variations = {"Nominal"};
+//vector<string> efficiency_variations = {"Final", "Nominal", "2xGauss", "MassUp", "MassDown", "BinUp", "BinDown"};
+
+//kind is "efficiency", "systematic_1D" or "systematic_2D"
+void batch_plots(string kind = "efficiency", int nworkers = 4)
+{
+	batch_plots(kind, datasets, quantities, muon_ids, efficiency_variations, "results/comparisons/", nworkers);
+}
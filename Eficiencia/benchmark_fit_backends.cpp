@@ -0,0 +1,114 @@
+//Fits the same bins with every likelihood backend and compares wall time, NLL evaluations and yields
+//Writes the time of every backend and its efficiency difference on every bin next to the validation record of validate_fast_fit.cpp
+//Usage: root -l -b -q benchmark_fit_backends.cpp
+//The times of cling include its just in time compilation. build/benchmark_fit_backends (CMakeLists.txt) times the compiled fits
+#include "src/root_headers.h"
+
+//Change if you need
+//#include "src/dofits/DoFit_Jpsi_Run.h"
+#include "src/dofits/DoFit_Jpsi_MC.h"
+
+#include "src/create_folder.h"
+
+string MuonId   = "trackerMuon";
+string quantity = "Pt";     vector<double> bins = {0., 3.0, 4.0, 5.0, 6.0, 8.0, 13.0, 40.};
+
+//{fit_backend, roofit_eval_backend, roofit_num_cpu}. The first one is the reference for the yields
+struct BackendSetting
+{
+	string backend;
+	string eval_backend;
+	int    num_cpu;
+};
+BackendSetting settings[] = {
+	{"roofit", "legacy",          1},
+	{"roofit", "legacy",          4},
+	{"roofit", "cpu",             1},
+	{"roofit", "codegen",         1},
+	{"roofit", "codegen_no_grad", 1},
+	{"fast",   "",                1}
+};
+
+void benchmark_fit_backends()
+{
+	RooMsgService::instance().setGlobalKillBelow(RooFit::WARNING);
+
+	//Every fit has to be done here, without cache and without plots
+	use_fit_cache = false;
+	fit_plot_mode = "none";
+	fit_bins = 100;
+	require_fast_validation = false;
+
+	//Data is read once before timing, so the first setting does not pay for it
+	load_probe_dataset(data_file_path);
+
+	const int nbins     = bins.size() - 1;
+	const int nsettings = sizeof(settings)/sizeof(*settings);
+
+	vector<double> total_time(nsettings, 0.);
+	vector<double> total_calls(nsettings, 0.);
+	vector<double> max_diff(nsettings, 0.);
+	vector<double> max_eff_diff(nsettings, 0.);
+	vector<vector<double>> reference(nbins);
+	vector<vector<double>> eff_diff(nsettings, vector<double>(nbins));
+
+	for (int s = 0; s < nsettings; s++)
+	{
+		fit_backend         = settings[s].backend;
+		roofit_eval_backend = settings[s].eval_backend;
+		roofit_num_cpu      = settings[s].num_cpu;
+
+		for (int i = 0; i < nbins; i++)
+		{
+			string conditions = string(    "ProbeMuon_" + quantity + ">=" + to_string(bins[i]  ));
+			conditions +=       string(" && ProbeMuon_" + quantity + "< " + to_string(bins[i+1]));
+
+			TStopwatch watch;
+			YieldsNErrs yields_n_errs = doFit(conditions, MuonId);
+			total_time[s]  += watch.RealTime();
+			total_calls[s] += last_fit_nll_calls;
+
+			//Difference of the yields to the reference, in units of the reference error
+			if (s == 0)
+				reference[i].assign(yields_n_errs.begin(), yields_n_errs.end());
+			double diff_all  = fabs(yields_n_errs[0] - reference[i][0])/reference[i][2];
+			double diff_pass = fabs(yields_n_errs[1] - reference[i][1])/reference[i][3];
+			max_diff[s] = max(max_diff[s], max(diff_all, diff_pass));
+
+			//Difference of the efficiency to the reference
+			eff_diff[s][i]  = yields_n_errs[1]/yields_n_errs[0] - reference[i][1]/reference[i][0];
+			max_eff_diff[s] = max(max_eff_diff[s], fabs(eff_diff[s][i]));
+		}
+	}
+
+	fit_backend         = "roofit";
+	roofit_eval_backend = "";
+	roofit_num_cpu      = 1;
+	require_fast_validation = true;
+
+	cout << "\n------------------------\n";
+	cout << "Benchmark over " << nbins << " bins of " << quantity << " (" << output_folder_name << ")\n";
+	printf("%-8s %-16s %4s %14s %16s %22s %18s\n", "backend", "evaluation", "cpus", "time/fit [s]", "NLL evals/fit", "max |diff|/err yields",
+		"max |diff| eff");
+	for (int s = 0; s < nsettings; s++)
+		printf("%-8s %-16s %4d %14.3f %16.1f %22.4f %18.6f\n", settings[s].backend.c_str(), settings[s].eval_backend.c_str(),
+			settings[s].num_cpu, total_time[s]/nbins, total_calls[s]/nbins, max_diff[s], max_eff_diff[s]);
+	cout << "Time per fit includes selecting the data, which is the same for every backend";
+	cout << "\n------------------------\n";
+
+	//Same numbers, with the efficiency difference of every bin
+	create_folder(fast_validation_folder.c_str());
+	string record_path = fast_validation_folder + "benchmark_fit_backends_" + output_folder_name + ".txt";
+	ofstream record(record_path);
+	record << "#benchmark_fit_backends.cpp on " << output_folder_name << " (" << data_file_path << "), " << MuonId << " by " << quantity << "\n";
+	record << "#backend evaluation cpus time/fit NLL_evals/fit max_diff/err_yields eff_diff_of_each_bin\n";
+	for (int s = 0; s < nsettings; s++)
+	{
+		record << settings[s].backend << " " << (settings[s].eval_backend != "" ? settings[s].eval_backend : "-") << " " << settings[s].num_cpu << " "
+			<< total_time[s]/nbins << " " << total_calls[s]/nbins << " " << max_diff[s];
+		for (int i = 0; i < nbins; i++)
+			record << " " << eff_diff[s][i];
+		record << "\n";
+	}
+	cout << "Record: " << record_path << "\n";
+}
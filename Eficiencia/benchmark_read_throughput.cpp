@@ -0,0 +1,110 @@
+//Writes the simplified tag and probe tree with several compression settings and measures how fast each one is read back
+//Usage: root -l -b -q benchmark_read_throughput.cpp
+//Read times are with the file on the page cache. Drop the cache between readings to measure the storage too
+//The input has to hold every branch itself (simplify_data.cpp "copy" mode), friend trees are not cloned
+#include "src/tree_output_settings.h"
+#include "src/create_folder.h"
+
+//Change if you need
+const char* input_path = "DATA/TagAndProbe_Jpsi_Run2011.root";
+const char* benchmark_folder = "results/read_benchmark/";
+
+//{algorithm, level, basket size, auto flush}
+struct OutputSetting
+{
+	string    algorithm;
+	int       level;
+	int       basket;
+	long long flush;
+};
+OutputSetting settings[] = {
+	{"zlib", 1, 32000,  -30000000},
+	{"zlib", 1, 256000, -30000000},
+	{"lz4",  4, 256000, -30000000},
+	{"lz4",  4, 256000, -100000000},
+	{"zstd", 5, 256000, -30000000},
+	{"lzma", 1, 256000, -30000000}
+};
+
+//Reads every branch of every entry, as load_probe_columns does. Returns the seconds it took
+double time_tree_reading(const char* path)
+{
+	TStopwatch watch;
+	TFile* file = TFile::Open(path);
+	TTree* tree = (TTree*)file->Get("tagandprobe");
+
+	double doubles[7];
+	int    ints[3];
+	const char* double_branches[] = {"InvariantMass", "ProbeMuon_Pt", "ProbeMuon_Eta", "ProbeMuon_Phi", "TagMuon_Pt", "TagMuon_Eta", "TagMuon_Phi"};
+	const char* int_branches[]    = {"PassingProbeTrackingMuon", "PassingProbeStandAloneMuon", "PassingProbeGlobalMuon"};
+	for (int i = 0; i < 7; i++)
+		tree->SetBranchAddress(double_branches[i], &doubles[i]);
+	for (int i = 0; i < 3; i++)
+		tree->SetBranchAddress(int_branches[i], &ints[i]);
+
+	long long entries = tree->GetEntries();
+	for (long long i = 0; i < entries; i++)
+		tree->GetEntry(i);
+
+	delete file;
+	return watch.RealTime();
+}
+
+void benchmark_read_throughput()
+{
+	create_folder(benchmark_folder);
+	enable_parallel_writing();
+
+	TFile* input = TFile::Open(input_path);
+	TTree* input_tree = (TTree*)input->Get("tagandprobe");
+	double uncompressed_mb = input_tree->GetTotBytes()/1048576.;
+
+	double source_read_time = time_tree_reading(input_path);
+
+	const int nsettings = sizeof(settings)/sizeof(*settings);
+	vector<double> write_time(nsettings), read_time(nsettings), file_mb(nsettings);
+	for (int s = 0; s < nsettings; s++)
+	{
+		compression_algorithm = settings[s].algorithm;
+		compression_level     = settings[s].level;
+		basket_size           = settings[s].basket;
+		auto_flush            = settings[s].flush;
+
+		string path = string(benchmark_folder) + "setting_" + to_string(s) + ".root";
+
+		TStopwatch watch;
+		TFile* output = open_output_file(path.c_str());
+		TTree* tree   = input_tree->CloneTree(0);
+		configure_output_tree(tree);
+		tree->CopyEntries(input_tree);
+		tree->Write("", TObject::kOverwrite);
+		output->Close();
+		write_time[s] = watch.RealTime();
+		delete output;
+
+		FileStat_t file_stat;
+		gSystem->GetPathInfo(path.c_str(), file_stat);
+		file_mb[s]   = file_stat.fSize/1048576.;
+		read_time[s] = time_tree_reading(path.c_str());
+
+		gSystem->Unlink(path.c_str());
+	}
+
+	delete input;
+
+	cout << "\n------------------------\n";
+	cout << "Read throughput of \"" << input_path << "\" (" << uncompressed_mb << " MB uncompressed)\n";
+	printf("%-60s %10s %12s %12s %14s\n", "settings", "size [MB]", "write [s]", "read [s]", "read [MB/s]");
+	printf("%-60s %10s %12s %12.2f %14.1f\n", "source file", "", "", source_read_time, uncompressed_mb/source_read_time);
+	for (int s = 0; s < nsettings; s++)
+	{
+		compression_algorithm = settings[s].algorithm;
+		compression_level     = settings[s].level;
+		basket_size           = settings[s].basket;
+		auto_flush            = settings[s].flush;
+		printf("%-60s %10.1f %12.2f %12.2f %14.1f\n", output_settings_description().c_str(),
+			file_mb[s], write_time[s], read_time[s], uncompressed_mb/read_time[s]);
+	}
+	cout << "Throughput is in uncompressed MB per second";
+	cout << "\n------------------------\n";
+}
@@ -0,0 +1,31 @@
+//Converts the tag and probe tree to the columnar file used by doFit (src/probe_columns.h)
+//The file is written next to the .root one, with .cols extension. doFit maps it instead of reading the tree while it is up to date
+//Accepts the same paths as data_file_path: one file, glob pattern, comma separated paths or .txt list
+//Usage: root -l -b -q 'convert_to_columnar.cpp("DATA/TagAndProbe_Jpsi_Run2011.root")'
+#include "src/probe_columns.h"
+
+void convert_to_columnar(const char* data_path = "DATA/TagAndProbe_Jpsi_Run2011.root")
+{
+	TStopwatch watch;
+	vector<string> files = expand_data_files(data_path);
+
+	//Each file is converted by its own thread
+	vector<long long> entries(files.size(), 0);
+	vector<double>    megabytes(files.size(), 0.);
+	for_each_file(files.size(), [&](unsigned i)
+	{
+		ProbeColumns* columns = read_probe_tree(files[i].c_str());
+		if (!write_columnar(columns, columnar_path(files[i].c_str())))
+			abort();
+
+		entries[i]   = columns->entries;
+		megabytes[i] = columns->memory_size/1048576.;
+		close_probe_columns(columns);
+	});
+
+	cout << "\n------------------------\n";
+	for (size_t i = 0; i < files.size(); i++)
+		cout << "Wrote " << entries[i] << " probes (" << megabytes[i] << " MB) to \"" << columnar_path(files[i].c_str()) << "\"\n";
+	cout << "Took " << watch.RealTime() << "s";
+	cout << "\n------------------------\n";
+}
@@ -0,0 +1,111 @@
+//Quick efficiency by sideband subtraction (src/cut_and_count.h), without fitting
+//Compares it with the last nominal fit of the results store (src/results_store.h) and lists the bins that differ, which are the ones worth fitting
+//Usage: root -l -b -q cut_and_count.cpp
+#include "src/root_headers.h"
+
+//Change if you need
+#include "src/dofits/DoFit_Jpsi_Run.h"
+//#include "src/dofits/DoFit_Jpsi_MC.h"
+
+#include "src/create_folder.h"
+#include "src/cut_and_count.h"
+#include "src/bin_edges.h"
+#include "src/results_store.h"
+
+//Which Muon Id do you want to study?
+string MuonId   = "trackerMuon";
+//string MuonId   = "standaloneMuon";
+//string MuonId   = "globalMuon";
+
+//Which quantity do you want to use?
+string quantity = "Pt";     vector<double> bins = {2.0, 3.4, 4.0, 4.4, 5.0, 5.6, 5.8, 6.0, 6.2, 6.4, 6.6, 6.8, 7.3, 9.5, 13.0, 17.0, 20.};
+//string quantity = "Eta";    vector<double> bins = {-2.4, -1.8, -1.4, -1.2, -1.0, -0.8, -0.5, -0.2, 0, 0.2, 0.5, 0.8, 1.0, 1.2, 1.4, 1.8, 2.4};
+//string quantity = "Phi";    vector<double> bins = {-3.0, -1.8, -1.6, -1.2, -1.0, -0.7, -0.4, -0.2, 0, 0.2, 0.4, 0.7, 1.0, 1.2, 1.6, 1.8, 3.0};
+
+//Bins file written by adaptive_binning.cpp. If it is not empty, its edges of quantity replace the bins above
+string bins_file = "";
+
+//A bin is flagged when the difference to the fit is bigger than this (absolute efficiency)
+double flag_threshold = 0.02;
+
+void cut_and_count()
+{
+	if (bins_file != "")
+		bins = read_bins(bins_file, quantity);
+	int nbins = bins.size() - 1;
+
+	TStopwatch watch;
+	vector<SidebandCounts> counts = count_on_grid(data_file_path, MuonId, quantity, bins);
+	double count_time = watch.RealTime();
+
+	//Last nominal fit of this dataset on the results store, written by efficiency.cpp or plot_sys_efficiency.cpp
+	string fit_key = results_key(output_folder_name, MuonId, quantity, "Nominal");
+	vector<EfficiencyRecord> fit_records = find_results(read_results(), output_folder_name, MuonId, quantity, "Nominal");
+	bool compare_fit = !fit_records.empty();
+	if (compare_fit)
+	{
+		bool same_bins = ((int)fit_records.size() == nbins);
+		for (int i = 0; same_bins && i < nbins; i++)
+			same_bins = (fabs(fit_records[i].low - bins[i]) < 1e-9 && fabs(fit_records[i].high - bins[i+1]) < 1e-9);
+		if (!same_bins)
+		{
+			cout << "Bins of run " << fit_records[0].run << " of " << fit_key << " are not the same of this run. Nothing to compare\n";
+			compare_fit = false;
+		}
+	}
+	else
+		cout << "No fit of " << fit_key << " on \"" << results_store_path << "\". Run efficiency.cpp to compare\n";
+
+	//Path where is going to save efficiency
+	string directoryToSave = string("results/efficiencies/cut_and_count/") + output_folder_name + string("/");
+	create_folder(directoryToSave.c_str());
+
+	string file_path = directoryToSave + prefix_file_name + quantity + "_" + MuonId + ".root";
+	TFile* generatedFile = new TFile(file_path.c_str(),"recreate");
+
+	TGraphAsymmErrors* graph = new TGraphAsymmErrors(nbins);
+	graph->SetName((MuonId + "_" + quantity + "_CutAndCount_Efficiency").c_str());
+	graph->SetTitle(("Cut and count efficiency for " + MuonId + " " + quantity + ";" + quantity + ";Efficiency").c_str());
+
+	vector<string> flagged;
+	printf("\n%-40s %10s %10s %10s %10s %10s\n", "bin", "window all", "window pass", "efficiency", "error", "fit");
+	for (int i = 0; i < nbins; i++)
+	{
+		string conditions = string(    "ProbeMuon_" + quantity + ">=" + to_string(bins[i]  ));
+		conditions +=       string(" && ProbeMuon_" + quantity + "< " + to_string(bins[i+1]));
+
+		double efficiency, error;
+		sideband_efficiency(counts[i], efficiency, error);
+
+		graph->SetPoint(i, (bins[i] + bins[i+1])/2., efficiency);
+		graph->SetPointError(i, (bins[i+1] - bins[i])/2., (bins[i+1] - bins[i])/2., error, error);
+
+		string fit_text = "";
+		bool   flag     = false;
+		if (compare_fit)
+		{
+			double fit_value = fit_records[i].efficiency;
+			fit_text = to_string(fit_value);
+			flag = (fabs(efficiency - fit_value) > flag_threshold);
+			if (flag)
+				flagged.push_back(conditions);
+		}
+
+		printf("%-40s %10.0f %10.0f %10.4f %10.4f %10s %s\n", conditions.c_str(), counts[i].n[0][0], counts[i].n[1][0],
+			efficiency, error, fit_text.c_str(), flag ? "<- differs from fit" : "");
+	}
+
+	graph->Write();
+	generatedFile->Close();
+
+	cout << "\n------------------------\n";
+	cout << "Counted " << nbins << " bins in " << count_time*1000. << " ms (" << count_time*1000./nbins << " ms per bin, data reading included)\n";
+	if (compare_fit)
+	{
+		cout << flagged.size() << " bins differ from run " << fit_records[0].run << " of the fit by more than " << flag_threshold << ":\n";
+		for (string conditions : flagged)
+			cout << "  " << conditions << "\n";
+	}
+	cout << "Output: " << file_path;
+	cout << "\n------------------------\n";
+}
@@ -1,3 +1,5 @@
+#include "src/root_headers.h"
+
 //Change if you need
 #include "src/dofits/DoFit_Jpsi_Run.h"
 //#include "src/dofits/DoFit_Jpsi_MC.h"
@@ -5,7 +7,9 @@
 #include "src/create_folder.h"
 #include "src/get_efficiency.h"
 #include "src/make_TH1D.h"
-#include "src/compare_efficiency.cpp"
+#include "src/bin_edges.h"
+#include "src/compare_efficiency.h"
+#include "src/results_records.h"
 
 //Which Muon Id do you want to study?
 string MuonId   = "trackerMuon";
@@ -13,9 +17,15 @@ string MuonId   = "trackerMuon";
 //string MuonId   = "globalMuon";
 
 //Which quantity do you want to use?
-string quantity = "Pt";     double bins[] = {2.0, 3.4, 4.0, 4.4, 5.0, 5.6, 5.8, 6.0, 6.2, 6.4, 6.6, 6.8, 7.3, 9.5, 13.0, 17.0, 20.};
-//string quantity = "Eta";    double bins[] = {-2.4, -1.8, -1.4, -1.2, -1.0, -0.8, -0.5, -0.2, 0, 0.2, 0.5, 0.8, 1.0, 1.2, 1.4, 1.8, 2.4};
-//string quantity = "Phi";    double bins[] = {-3.0, -1.8, -1.6, -1.2, -1.0, -0.7, -0.4, -0.2, 0, 0.2, 0.4, 0.7, 1.0, 1.2, 1.6, 1.8, 3.0};
+string quantity = "Pt";     vector<double> bins = {2.0, 3.4, 4.0, 4.4, 5.0, 5.6, 5.8, 6.0, 6.2, 6.4, 6.6, 6.8, 7.3, 9.5, 13.0, 17.0, 20.};
+//string quantity = "Eta";    vector<double> bins = {-2.4, -1.8, -1.4, -1.2, -1.0, -0.8, -0.5, -0.2, 0, 0.2, 0.5, 0.8, 1.0, 1.2, 1.4, 1.8, 2.4};
+//string quantity = "Phi";    vector<double> bins = {-3.0, -1.8, -1.6, -1.2, -1.0, -0.7, -0.4, -0.2, 0, 0.2, 0.4, 0.7, 1.0, 1.2, 1.6, 1.8, 3.0};
+
+//Bins file written by adaptive_binning.cpp. If it is not empty, its edges of quantity replace the bins above
+string bins_file = "";
+
+//Set it true when files are appended to data_file_path: only the new files are read and only the bins they change are fitted
+bool incremental = false;
 
 void efficiency()
 {
@@ -23,9 +33,16 @@ void efficiency()
 	const char* path_bins_fit_folder = "results/bins_fit/efficiency/";
 	create_folder(path_bins_fit_folder, true);
 
+	use_incremental_partials = incremental;
+
 	// Loop for every bin and fit it
-	int nbins = sizeof(bins)/sizeof(*bins) - 1;
-	double** yields_n_errs = new double*[nbins];
+	if (bins_file != "")
+		bins = read_bins(bins_file, quantity);
+	int nbins = bins.size() - 1;
+	vector<YieldsNErrs> yields_n_errs(nbins);
+	vector<FitInfo>     fit_info(nbins);
+	vector<string>      bin_conditions;
+	vector<ToyStudy> toy_studies;
 	for (int i = 0; i < nbins; i++)
 	{
 		//Creates conditions
@@ -34,6 +51,10 @@ void efficiency()
 
 		//Stores [yield_all, yield_pass, err_all, err_pass]
 		yields_n_errs[i] = doFit(conditions, MuonId, path_bins_fit_folder);
+		fit_info[i]      = last_fit_info;
+		bin_conditions.push_back(conditions);
+		if (toys_per_bin > 0)
+			toy_studies.push_back(last_toy_study);
 	}
 
 	//Path where is going to save efficiency 
@@ -47,21 +68,39 @@ void efficiency()
 	//Create histograms
 	generatedFile->mkdir("histograms/");
 	generatedFile->   cd("histograms/");
-	TH1D *yield_all  = make_TH1D("ALL" , yields_n_errs, 0, bins, nbins, quantity);
-	TH1D *yield_pass = make_TH1D("PASS", yields_n_errs, 1, bins, nbins, quantity);
+	TH1D *yield_all  = make_TH1D("ALL" , yields_n_errs, 0, bins.data(), nbins, quantity);
+	TH1D *yield_pass = make_TH1D("PASS", yields_n_errs, 1, bins.data(), nbins, quantity);
 	
 	//Create efficiencies
 	generatedFile->   cd("/");
-	get_efficiency(yield_all, yield_pass, quantity, nbins, MuonId, "", true);
+	TEfficiency* pEff = get_efficiency(yield_all, yield_pass, quantity, nbins, MuonId, "", true);
+
+	//Efficiency with the intervals of the toys, and their distributions
+	if (toys_per_bin > 0)
+	{
+		generatedFile->mkdir("toys/");
+		generatedFile->   cd("toys/");
+		write_toy_studies(toy_studies, bins.data(), nbins, quantity, MuonId);
+		generatedFile->   cd("/");
+	}
+
+	//Health of the fit of every bin
+	write_fit_health({"Nominal"}, {fit_info}, bin_conditions);
 
 	//Write file
 	generatedFile->Write();
 
+	//Records the efficiency of every bin on the results store
+	append_results(efficiency_records(pEff, bins, quantity, MuonId, "Nominal", fit_model, yields_n_errs, fit_info));
+
 	cout << "\n[Settings]\n";
 	cout << output_folder_name << "\n"<< quantity << " " << MuonId << "\n";
-	cout << "Fitting:     " << fit_functions << "\n";
+	cout << "Fitting:     " << fit_model_definitions[fit_model] << "\n";
 	cout << "Fit between: " << _mmin << " and " << _mmax << " GeV\n";
 	cout << "Bins:        " << fit_bins << "\n";
+	if (toys_per_bin > 0)
+		cout << "Toys:        " << toys_per_bin << " by bin (" << toy_mode << ")\n";
+	cout << "Memory:      " << memory_summary() << "\n";
 
 	cout << "\n------------------------\n";
 	cout << "Output: " << file_path;
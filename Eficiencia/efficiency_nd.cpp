@@ -0,0 +1,110 @@
+//Efficiency on several quantities at once (see src/efficiency_nd.h). Only cells with enough probes are fitted
+//Output has THnSparse of yields and efficiency, and the efficiency can be read back with src/efficiency_lookup.h for event weighting
+//Usage: root -l -b -q efficiency_nd.cpp
+#include "src/root_headers.h"
+
+//Change if you need
+#include "src/dofits/DoFit_Jpsi_Run.h"
+//#include "src/dofits/DoFit_Jpsi_MC.h"
+
+#include "src/create_folder.h"
+#include "src/efficiency_nd.h"
+
+//Which Muon Id do you want to study?
+string MuonId   = "trackerMuon";
+//string MuonId   = "standaloneMuon";
+//string MuonId   = "globalMuon";
+
+//Axes of the grid: quantity, edges and if its absolute value is binned
+vector<NDAxis> axes = {
+	{"Pt",  {0.0, 3.4, 4.0, 5.0, 6.0, 8.0, 40.},      false},
+	{"Eta", {0.0, 0.4, 0.6, 0.95, 1.2, 1.4, 2.4},     true},
+	{"Phi", {-3.15, -1.6, 0.0, 1.6, 3.15},            false}
+};
+
+//Cells with fewer probes of ALL in the fit range are not fitted and stay empty
+long long min_probes_per_cell = 200;
+
+void efficiency_nd()
+{
+	string name = MuonId;
+	for (const NDAxis& axis : axes)
+		name += "_" + axis.quantity;
+
+	//Path where is going to save results png for every cell
+	string path_bins_fit_folder = string("results/bins_fit/efficiency_nd/") + output_folder_name + "/" + name + "/";
+	create_folder(path_bins_fit_folder.c_str(), true);
+
+	//Counts every cell in one pass. Only the populated ones are kept
+	TStopwatch watch;
+	map<long long, long long> counts = count_nd_cells(data_file_path, axes);
+	vector<long long> cells;
+	for (auto& cell : counts)
+		if (cell.second >= min_probes_per_cell)
+			cells.push_back(cell.first);
+	cout << "Cells: " << cells.size() << " to fit, " << counts.size() << " with probes, " << nd_total_cells(axes) << " on the grid ("
+		<< watch.RealTime() << "s to count)\n";
+
+	//Fits every populated cell
+	vector<YieldsNErrs> yields_n_errs(cells.size());
+	vector<FitInfo>     fit_info(cells.size());
+	vector<string>      conditions;
+	for (size_t c = 0; c < cells.size(); c++)
+	{
+		conditions.push_back(nd_cell_condition(axes, cells[c]));
+		yields_n_errs[c] = doFit(conditions[c], MuonId, path_bins_fit_folder.c_str());
+		fit_info[c]      = last_fit_info;
+	}
+
+	//Path where is going to save efficiency
+	string directoryToSave = string("results/efficiencies/efficiency_nd/") + output_folder_name + "/";
+	create_folder(directoryToSave.c_str());
+
+	string file_path = directoryToSave + prefix_file_name + name + ".root";
+	TFile* generatedFile = new TFile(file_path.c_str(), "recreate");
+
+	generatedFile->mkdir("histograms/");
+	generatedFile->   cd("histograms/");
+	THnSparseD* hist_all  = create_nd_histogram("all",  "All",  axes);
+	THnSparseD* hist_pass = create_nd_histogram("pass", "Pass", axes);
+
+	generatedFile->   cd("/");
+	THnSparseD* heff = create_nd_histogram(name + "_Efficiency", "Efficiency for " + MuonId, axes);
+	for (size_t c = 0; c < cells.size(); c++)
+	{
+		const YieldsNErrs& yields = yields_n_errs[c];
+		set_nd_bin(hist_all,  axes, cells[c], yields[0], yields[2]);
+		set_nd_bin(hist_pass, axes, cells[c], yields[1], yields[3]);
+
+		//Passing and failing probes are independent, as in sideband_efficiency. FAILING is ALL - PASSING, with the error ALL has beyond PASSING
+		double total      = yields[0];
+		double pass       = yields[1];
+		double fail       = total - pass;
+		double error_pass = yields[3];
+		double error_fail = sqrt(max(yields[2]*yields[2] - yields[3]*yields[3], 0.));
+		double value      = (total > 0.) ? pass/total : 0.;
+		double uncertain  = (total > 0.) ? sqrt(fail*fail*error_pass*error_pass + pass*pass*error_fail*error_fail)/(total*total) : 0.;
+		set_nd_bin(heff, axes, cells[c], value, uncertain);
+	}
+	generatedFile->cd("histograms/");
+	hist_all ->Write();
+	hist_pass->Write();
+	generatedFile->cd("/");
+	heff->Write();
+
+	//Health of the fit of every cell
+	write_fit_health({"Nominal"}, {fit_info}, conditions);
+
+	generatedFile->Write();
+
+	cout << "\n[Settings]\n";
+	cout << output_folder_name << "\n" << name << "\n";
+	cout << "Fitting:     " << fit_model_definitions[fit_model] << "\n";
+	cout << "Fit between: " << _mmin << " and " << _mmax << " GeV\n";
+	cout << "Cells:       " << cells.size() << " fitted of " << nd_total_cells(axes) << "\n";
+	cout << "Memory:      " << memory_summary() << "\n";
+
+	cout << "\n------------------------\n";
+	cout << "Output: " << file_path;
+	cout << "\n------------------------\n";
+}
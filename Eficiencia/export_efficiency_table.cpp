@@ -0,0 +1,118 @@
+//Writes an efficiency of plot_sys_efficiency_2d.cpp or plot_sys_efficiency.cpp as a flat text table for src/efficiency_table.h
+//Every cell has the final efficiency, its statistic error (of the nominal fits) and its systematic error (the rest of the final error)
+//Usage: root -l -b -q 'export_efficiency_table.cpp("results/efficiencies/systematic_2D/Jpsi_Run_2011/Eta_Pt_trackerMuon.root")'
+#include "src/root_headers.h"
+#include "src/create_folder.h"
+
+//Which Muon Id do you want to export?
+string MuonId   = "trackerMuon";
+//string MuonId   = "standaloneMuon";
+//string MuonId   = "globalMuon";
+
+//Quantities of the efficiency. yquantity is only used by 2D efficiencies, that bin its absolute value
+string xquantity = "Pt";
+string yquantity = "Eta";
+
+//Name of the variation with the statistic errors
+string nominal_name = "Nominal";
+
+//Folder of the tables
+string tables_folder = "results/tables/";
+
+struct TableCell
+{
+	double efficiency, stat, syst;
+};
+
+//Systematic error is what is left of the final error without the statistic one
+TableCell table_cell(double efficiency, double total, double stat)
+{
+	return {efficiency, stat, sqrt(max(0., total*total - stat*stat))};
+}
+
+//Larger side of the error of a TEfficiency bin
+double efficiency_error(TEfficiency* pEff, int bin)
+{
+	return max(pEff->GetEfficiencyErrorLow(bin), pEff->GetEfficiencyErrorUp(bin));
+}
+
+string axis_edges(TAxis* axis)
+{
+	string edges;
+	for (int i = 1; i <= axis->GetNbins() + 1; i++)
+		edges += " " + to_string(axis->GetBinLowEdge(i));
+	return edges;
+}
+
+void export_efficiency_table(string input, string output = "")
+{
+	TDirectory* previous_dir = gDirectory;
+	TFile* file = TFile::Open(input.c_str());
+	previous_dir->cd();
+	if (file == NULL || file->IsZombie())
+	{
+		cerr << "Could not open \"" << input << "\" efficiency file\n";
+		abort();
+	}
+
+	string prefix = MuonId + "_" + yquantity + "_" + xquantity + "_";
+	TH2D* final_2d   = (TH2D*)file->Get((prefix + "Final_Efficiency").c_str());
+	TH2D* nominal_2d = (TH2D*)file->Get((prefix + nominal_name + "_Efficiency").c_str());
+
+	string xline, yline;
+	vector<TableCell> cells;
+	if (final_2d != NULL && nominal_2d != NULL)
+	{
+		xline = "x " + xquantity + axis_edges(final_2d->GetXaxis());
+		yline = "y abs(" + yquantity + ")" + axis_edges(final_2d->GetYaxis());
+		for (int j = 1; j <= final_2d->GetNbinsY(); j++)
+			for (int i = 1; i <= final_2d->GetNbinsX(); i++)
+				cells.push_back(table_cell(final_2d->GetBinContent(i, j), final_2d->GetBinError(i, j), nominal_2d->GetBinError(i, j)));
+	}
+	else
+	{
+		TEfficiency* final_1d   = (TEfficiency*)file->Get((MuonId + "_" + xquantity + "_Efficiency").c_str());
+		TEfficiency* nominal_1d = (TEfficiency*)file->Get((MuonId + "_" + xquantity + "_" + nominal_name + "_Efficiency").c_str());
+		if (final_1d == NULL || nominal_1d == NULL)
+		{
+			cerr << "Could not find the final and " << nominal_name << " efficiencies of " << MuonId << " in \"" << input << "\"\n";
+			abort();
+		}
+
+		TAxis* axis = final_1d->GetTotalHistogram()->GetXaxis();
+		xline = "x " + xquantity + axis_edges(axis);
+		for (int i = 1; i <= axis->GetNbins(); i++)
+			cells.push_back(table_cell(final_1d->GetEfficiency(i), efficiency_error(final_1d, i), efficiency_error(nominal_1d, i)));
+	}
+
+	//Table next to the others, named after the input file
+	if (output == "")
+	{
+		create_folder(tables_folder.c_str());
+		string name = input.substr(input.find_last_of('/') + 1);
+		output = tables_folder + name.substr(0, name.find_last_of('.')) + ".txt";
+	}
+
+	ofstream table(output);
+	if (!table)
+	{
+		cerr << "Could not write \"" << output << "\"\n";
+		abort();
+	}
+	table << "#Efficiency of " << MuonId << " from " << input << "\n";
+	table << "#Cells: efficiency stat syst, x changing fastest\n";
+	table << xline << "\n";
+	if (yline != "")
+		table << yline << "\n";
+	table.precision(7);
+	for (const TableCell& cell : cells)
+		table << cell.efficiency << " " << cell.stat << " " << cell.syst << "\n";
+
+	file->Close();
+	delete file;
+
+	cout << "\n------------------------\n";
+	cout << "Cells:  " << cells.size() << "\n";
+	cout << "Output: " << output;
+	cout << "\n------------------------\n";
+}
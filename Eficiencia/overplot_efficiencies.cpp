@@ -1,3 +1,4 @@
+//batch_plots.cpp draws these variations for every dataset, quantity and Muon Id in one run
 #include "src/create_folder.h"
 
 TEfficiency* read_TEfficiency(const char* folder_path, const char* file_name, const char* TEfficiency_path)
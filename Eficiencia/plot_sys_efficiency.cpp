@@ -1,10 +1,15 @@
+#include "src/root_headers.h"
+
 //Change if you need
 #include "src/dofits/DoFit_Jpsi_Run.h"
-#include "src/dofits/DoFit_Jpsi_Run_2xGaus.h"
+//#include "src/dofits/DoFit_Jpsi_MC.h"
 
 #include "src/create_folder.h"
 #include "src/get_efficiency.h"
 #include "src/make_TH1D.h"
+#include "src/bin_edges.h"
+#include "src/work_queue.h"
+#include "src/results_records.h"
 
 //Which Muon Id do you want to study?
 string MuonId   = "trackerMuon";
@@ -12,15 +17,33 @@ string MuonId   = "trackerMuon";
 //string MuonId   = "globalMuon";
 
 //Which quantity do you want to use?
-string quantity = "Pt";     double bins[] = {0., 3.0, 3.6, 4.0, 4.4, 4.7, 5.0, 5.6, 5.8, 6.0, 6.2, 6.4, 6.6, 6.8, 7.3, 9.5, 13.0, 17.0, 40.};
-//string quantity = "Eta";    double bins[] = {-2.4, -1.4, -1.2, -1.0, -0.8, -0.5, -0.2, 0, 0.2, 0.5, 0.8, 1.0, 1.2, 1.4, 2.4};
-//string quantity = "Phi";    double bins[] = {-3.0, -1.8, -1.6, -1.2, -1.0, -0.7, -0.4, -0.2, 0, 0.2, 0.4, 0.7, 1.0, 1.2, 1.6, 1.8, 3.0};
+string quantity = "Pt";     vector<double> bins = {0., 3.0, 3.6, 4.0, 4.4, 4.7, 5.0, 5.6, 5.8, 6.0, 6.2, 6.4, 6.6, 6.8, 7.3, 9.5, 13.0, 17.0, 40.};
+//string quantity = "Eta";    vector<double> bins = {-2.4, -1.4, -1.2, -1.0, -0.8, -0.5, -0.2, 0, 0.2, 0.5, 0.8, 1.0, 1.2, 1.4, 2.4};
+//string quantity = "Phi";    vector<double> bins = {-3.0, -1.8, -1.6, -1.2, -1.0, -0.7, -0.4, -0.2, 0, 0.2, 0.4, 0.7, 1.0, 1.2, 1.6, 1.8, 3.0};
+
+//string quantity = "Pt";     vector<double> bins = {0.0, 2.0, 3.4, 4.0, 5.0, 6.0, 8.0, 10.0, 40.};
+//string quantity = "Eta";    vector<double> bins = {0.0, 0.4, 0.6, 0.95, 1.2, 1.4, 1.6, 1.8, 2.4};
+
+//Bins file written by adaptive_binning.cpp. If it is not empty, its edges of quantity replace the bins above
+string bins_file = "";
 
-//string quantity = "Pt";     double bins[] = {0.0, 2.0, 3.4, 4.0, 5.0, 6.0, 8.0, 10.0, 40.};
-//string quantity = "Eta";    double bins[] = {0.0, 0.4, 0.6, 0.95, 1.2, 1.4, 1.6, 1.8, 2.4};
+//Seeds the systematic variation fits with the nominal fit of the same bin
+bool use_warm_start = true;
+
+//Every fit is stored as soon as it ends on a checkpoint next to the output file
+//If true, fits stored by a previous run with the same settings are not done again (after a crash, for example)
+bool resume = false;
+
+//"local" fits here. "queue" writes every fit as a task of a work queue in queue_folder, works on it and assembles the results
+//Workers on other hosts sharing this folder join with queue_worker.cpp. A queue left by a crash is reused with its results
+string run_mode     = "local";
+string queue_folder = "results/queue/";
 
 void plot_sys_efficiency()
 {
+	//Built here, so they follow fit_model, the fit range and fit_bins set before the call
+	vector<Variation> variations = make_variations();
+
 	//First enable implicit multi-threading globally, so that the implicit parallelisation is on.
 	//The parameter of the call specifies the number of threads to use.
 	//int nthreads = 4;
@@ -28,96 +51,34 @@ void plot_sys_efficiency()
 
 	//Path where is going to save results png for every bin 
 	string path_bins_fit_folder = string("results/bins_fit/systematic_1D/") + output_folder_name + string("/") + quantity + string("/") + MuonId + string("/");
-	create_folder(path_bins_fit_folder.c_str(), true);
+	create_folder(path_bins_fit_folder.c_str(), !resume);
+
+	//Path where is going to save efficiency 
+	string directoryToSave = string("results/efficiencies/systematic_1D/") + output_folder_name + string("/");
+	create_folder(directoryToSave.c_str());
 
 	// Loop for every bin and fit it
-	int nbins = sizeof(bins)/sizeof(*bins) - 1;
-
-	//Creates variables to store values and error of each passed and total bin
-	//Stores [yield_all, yield_pass, err_all, err_pass]
-	double** yields_n_errs_Nominal  = new double*[nbins];
-	double** yields_n_errs_2Gauss   = new double*[nbins];
-	double** yields_n_errs_MassUp   = new double*[nbins];
-	double** yields_n_errs_MassDown = new double*[nbins];
-	double** yields_n_errs_BinUp    = new double*[nbins];
-	double** yields_n_errs_BinDown  = new double*[nbins];
-	double** yields_n_errs          = new double*[nbins];
+	if (bins_file != "")
+		bins = read_bins(bins_file, quantity);
+	int nbins = bins.size() - 1;
 
+	//Creates conditions of every bin
+	vector<string> conditions;
 	for (int i = 0; i < nbins; i++)
 	{
-		//Creates conditions
-		string conditions = string(    "ProbeMuon_" + quantity + ">=" + to_string(bins[i]  ));
-		conditions +=       string(" && ProbeMuon_" + quantity + "< " + to_string(bins[i+1]));
-
-		double default_min = _mmin;
-		double default_max = _mmax;
-		string mmin_string = "";
-		string mmax_string = "";
-
-		//Nominal
-		_mmin = default_min;
-		_mmax = default_max;
-		fit_bins = 100;
-		prefix_file_name = "nominal_";
-		yields_n_errs_Nominal[i] = doFit(conditions, MuonId, (path_bins_fit_folder + prefix_file_name).c_str());
-
-		//2Gauss
-		_mmin = default_min;
-		_mmax = default_max;
-		fit_bins = 100;
-		prefix_file_name = "2xgaus_";
-		yields_n_errs_2Gauss[i] = doFit2xGaus(conditions, MuonId, (path_bins_fit_folder + prefix_file_name).c_str());
-
-		//MassUp
-		_mmin = default_min - 0.05;
-		_mmax = default_max + 0.05;
-		fit_bins = 100;
-		mmin_string = to_string(_mmin);
-		mmax_string = to_string(_mmax);
-		replace(mmin_string.begin(), mmin_string.end(), '.', 'p');
-		replace(mmax_string.begin(), mmax_string.end(), '.', 'p');
-		prefix_file_name  = string("mass_") + mmin_string.substr(0, mmin_string.length()-4) + string("_");
-		prefix_file_name +=                   mmax_string.substr(0, mmax_string.length()-4) + string("_");
-		yields_n_errs_MassUp[i] = doFit(conditions, MuonId, (path_bins_fit_folder + prefix_file_name).c_str());
-
-		//MassDown
-		_mmin = default_min + 0.05;
-		_mmax = default_max - 0.05;
-		fit_bins = 100;
-		mmin_string = to_string(_mmin);
-		mmax_string = to_string(_mmax);
-		replace(mmin_string.begin(), mmin_string.end(), '.', 'p');
-		replace(mmax_string.begin(), mmax_string.end(), '.', 'p');
-		prefix_file_name  = string("mass_") + mmin_string.substr(0, mmin_string.length()-4) + string("_");
-		prefix_file_name +=                   mmax_string.substr(0, mmax_string.length()-4) + string("_");
-		yields_n_errs_MassDown[i] = doFit(conditions, MuonId, (path_bins_fit_folder + prefix_file_name).c_str());
-
-		//BinUp
-		_mmin = default_min;
-		_mmax = default_max;
-		fit_bins = 105;
-		prefix_file_name = "binfit105_";
-		yields_n_errs_BinUp[i] = doFit(conditions, MuonId, (path_bins_fit_folder + prefix_file_name).c_str());
-
-		//BinDown
-		_mmin = default_min;
-		_mmax = default_max;
-		fit_bins = 95;
-		prefix_file_name = "binfit95_";
-		yields_n_errs_BinDown[i] = doFit(conditions, MuonId, (path_bins_fit_folder + prefix_file_name).c_str());
-
-		//Calculates the result
-		double* result = new double[4];
-		result[0] = yields_n_errs_Nominal[i][0];
-		result[1] = yields_n_errs_Nominal[i][1];
-		result[2] = sqrt(pow(yields_n_errs_Nominal[i][2],2) + pow(yields_n_errs_2Gauss[i][2],2) + pow(yields_n_errs_MassUp[i][2],2) + pow(yields_n_errs_MassUp[i][2],2) + pow(yields_n_errs_BinUp[i][2],2) + pow(yields_n_errs_BinDown[i][2],2));
-		result[3] = sqrt(pow(yields_n_errs_Nominal[i][3],2) + pow(yields_n_errs_2Gauss[i][3],2) + pow(yields_n_errs_MassUp[i][3],2) + pow(yields_n_errs_MassUp[i][3],2) + pow(yields_n_errs_BinUp[i][3],2) + pow(yields_n_errs_BinDown[i][3],2));
-		yields_n_errs[i] = result;
+		string condition = string(    "ProbeMuon_" + quantity + ">=" + to_string(bins[i]  ));
+		condition +=       string(" && ProbeMuon_" + quantity + "< " + to_string(bins[i+1]));
+		conditions.push_back(condition);
 	}
 
-	//Path where is going to save efficiency 
-	string directoryToSave = string("results/efficiencies/systematic_1D/") + output_folder_name + string("/");
-	create_folder(directoryToSave.c_str());
+	//Fits every variation of src/variations.h on every bin
+	VariationResults results;
+	if (run_mode == "queue")
+		results = run_variations_on_queue(variations, conditions, MuonId, path_bins_fit_folder,
+			queue_folder + output_folder_name + "_" + MuonId + "_" + quantity + "/");
+	else
+		results = run_variations(variations, conditions, MuonId, path_bins_fit_folder, use_warm_start,
+			directoryToSave + quantity + "_" + MuonId + ".checkpoint.txt", resume);
 
 	//Create file
 	string file_path = directoryToSave + quantity + "_" + MuonId + ".root";
@@ -125,34 +86,49 @@ void plot_sys_efficiency()
 	generatedFile->mkdir("histograms/");
 	generatedFile->   cd("histograms/");
 	
-	TH1D* hist_all           = make_TH1D("all"          , yields_n_errs         , 0, bins, nbins, quantity);
-	TH1D* hist_nominal_all   = make_TH1D("all_nominal"  , yields_n_errs_Nominal , 0, bins, nbins, quantity);
-	TH1D* hist_2gaus_all     = make_TH1D("all_2xGauss"  , yields_n_errs_2Gauss  , 0, bins, nbins, quantity);
-	TH1D* hist_massup_all    = make_TH1D("all_MassUp"   , yields_n_errs_MassUp  , 0, bins, nbins, quantity);
-	TH1D* hist_massdown_all  = make_TH1D("all_MassDown" , yields_n_errs_MassDown, 0, bins, nbins, quantity);
-	TH1D* hist_binup_all     = make_TH1D("all_BinUp"    , yields_n_errs_BinUp   , 0, bins, nbins, quantity);
-	TH1D* hist_bindown_all   = make_TH1D("all_BinDown"  , yields_n_errs_BinDown , 0, bins, nbins, quantity);
-
-	TH1D* hist_pass          = make_TH1D("pass"         , yields_n_errs         , 1, bins, nbins, quantity);
-	TH1D* hist_2gaus_pass    = make_TH1D("pass_2xGauss" , yields_n_errs_Nominal , 1, bins, nbins, quantity);
-	TH1D* hist_nominal_pass  = make_TH1D("pass_nominal" , yields_n_errs_2Gauss  , 1, bins, nbins, quantity);
-	TH1D* hist_massup_pass   = make_TH1D("pass_MassUp"  , yields_n_errs_MassUp  , 1, bins, nbins, quantity);
-	TH1D* hist_massdown_pass = make_TH1D("pass_MassDown", yields_n_errs_MassDown, 1, bins, nbins, quantity);
-	TH1D* hist_binup_pass    = make_TH1D("pass_BinDown" , yields_n_errs_BinUp   , 1, bins, nbins, quantity);
-	TH1D* hist_bindown_pass  = make_TH1D("pass_BinDown" , yields_n_errs_BinDown , 1, bins, nbins, quantity);
+	TH1D* hist_all  = make_TH1D("all" , results.final, 0, bins.data(), nbins, quantity);
+	TH1D* hist_pass = make_TH1D("pass", results.final, 1, bins.data(), nbins, quantity);
+	vector<TH1D*> hists_all, hists_pass;
+	for (size_t v = 0; v < variations.size(); v++)
+	{
+		hists_all .push_back(make_TH1D("all_"  + variations[v].tag, results.yields_n_errs[v], 0, bins.data(), nbins, quantity));
+		hists_pass.push_back(make_TH1D("pass_" + variations[v].tag, results.yields_n_errs[v], 1, bins.data(), nbins, quantity));
+	}
 
+	//Final efficiency has the fit information of the nominal fits
 	generatedFile->   cd("/");
-	get_efficiency(hist_all         , hist_pass         , quantity, MuonId, ""        , true);
-	get_efficiency(hist_nominal_all , hist_2gaus_pass   , quantity, MuonId, "Nominal" , true);
-	get_efficiency(hist_2gaus_all   , hist_nominal_pass , quantity, MuonId, "2xGauss" , true);
-	get_efficiency(hist_massup_all  , hist_massup_pass  , quantity, MuonId, "MassUp"  , true);
-	get_efficiency(hist_massdown_all, hist_massdown_pass, quantity, MuonId, "MassDown", true);
-	get_efficiency(hist_binup_all   , hist_binup_pass   , quantity, MuonId, "BinUp"   , true);
-	get_efficiency(hist_bindown_all , hist_bindown_pass , quantity, MuonId, "BinDown" , true);
+	vector<EfficiencyRecord> records = efficiency_records(get_efficiency(hist_all, hist_pass, quantity, nbins, MuonId, "", true),
+		bins, quantity, MuonId, "Final", "", results.final, results.fit_info[nominal_variation(variations)]);
+	for (size_t v = 0; v < variations.size(); v++)
+	{
+		TEfficiency* pEff = get_efficiency(hists_all[v], hists_pass[v], quantity, nbins, MuonId, variations[v].name, true);
+		vector<EfficiencyRecord> variation_records = efficiency_records(pEff, bins, quantity, MuonId, variations[v].name, variations[v].model,
+			results.yields_n_errs[v], results.fit_info[v]);
+		records.insert(records.end(), variation_records.begin(), variation_records.end());
+	}
+
+	//Efficiency of the nominal fits with the intervals of their toys, and their distributions
+	if (!results.toy_studies.empty())
+	{
+		generatedFile->mkdir("toys/");
+		generatedFile->   cd("toys/");
+		write_toy_studies(results.toy_studies, bins.data(), nbins, quantity, MuonId);
+	}
+
+	//Health of every fit of every variation
+	generatedFile->cd("/");
+	vector<string> variation_names;
+	for (const Variation& variation : variations)
+		variation_names.push_back(variation.name);
+	write_fit_health(variation_names, results.fit_info, conditions);
 
 	generatedFile->Write();
 
+	//Records every efficiency on the results store
+	append_results(records);
+
 	cout << "\n------------------------\n";
+	cout << "Memory: " << memory_summary() << "\n";
 	cout << "Output: " << file_path;
 	cout << "\n------------------------\n";
 }
\ No newline at end of file
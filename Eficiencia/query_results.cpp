@@ -0,0 +1,45 @@
+//Lists the runs of an efficiency recorded on the results store (src/results_store.h) and the bins of one of them
+//Usage: root -l -b -q 'query_results.cpp("Jpsi_Run_2011", "trackerMuon", "Pt", "Nominal")'
+#include "src/root_headers.h"
+#include "src/dofits/DoFit_Jpsi_Run.h"
+#include "src/results_store.h"
+
+//run = 0 shows the last run
+void query_results(string dataset = "Jpsi_Run_2011", string MuonId = "trackerMuon", string quantity = "Pt", string variation = "Nominal", int run = 0,
+	string path = results_store_path)
+{
+	ResultsStore store = read_results(path);
+	if (store.records.empty())
+	{
+		cerr << "Could not find any result in \"" << path << "\"\n";
+		return;
+	}
+
+	vector<int> runs = result_runs(store, dataset, MuonId, quantity, variation);
+	if (runs.empty())
+	{
+		cerr << "No result for " << results_key(dataset, MuonId, quantity, variation) << ". Efficiencies in the store:\n";
+		for (auto& entry : store.index)
+			cerr << "  " << entry.first << "\n";
+		return;
+	}
+
+	cout << results_key(dataset, MuonId, quantity, variation) << "\n";
+	for (int found_run : runs)
+	{
+		vector<EfficiencyRecord> records = find_results(store, dataset, MuonId, quantity, variation, found_run);
+		cout << "  run " << found_run << " (" << records[0].time << "): " << records.size() << " bins, model \"" << records[0].model << "\"\n";
+	}
+
+	vector<EfficiencyRecord> records = find_results(store, dataset, MuonId, quantity, variation, run);
+	if (records.empty())
+	{
+		cerr << "Run " << run << " does not have this efficiency\n";
+		return;
+	}
+
+	printf("\nRun %d\n%4s %21s %21s %9s %9s %9s %6s %8s\n", records[0].run, "bin", "x", "y", "eff", "-err", "+err", "status", "time(s)");
+	for (const EfficiencyRecord& record : records)
+		printf("%4d [%8.3f, %8.3f] [%8.3f, %8.3f] %9.5f %9.5f %9.5f %6d %8.2f\n", record.bin, record.low, record.high, record.ylow, record.yhigh,
+			record.efficiency, record.err_low, record.err_high, record.fit_status, record.fit_seconds);
+}
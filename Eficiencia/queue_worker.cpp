@@ -0,0 +1,27 @@
+//Worker of a work queue written by plot_sys_efficiency.cpp or plot_sys_efficiency_2d.cpp with run_mode = "queue"
+//Run as many as you want, on any host that sees the queue folder, from this folder. Each one ends when there is nothing left to claim
+//Usage: root -l -b -q 'queue_worker.cpp("results/queue/Jpsi_Run_2011_trackerMuon_Eta_Pt/")'
+//Tasks carry their dataset, data file, tag cut and model, every model of src/dofits/fit_models.h is available
+#include "src/root_headers.h"
+
+//Any of them works on queues of every dataset: the output folder name of each task replaces the one of this header while it runs,
+//and the datasets of src/dofits/datasets.h share the fit parameters taken from the header
+#include "src/dofits/DoFit_Jpsi_Run.h"
+//#include "src/dofits/DoFit_Jpsi_MC.h"
+
+#include "src/create_folder.h"
+#include "src/work_queue.h"
+
+void queue_worker(string queue)
+{
+	if (queue.back() != '/')
+		queue += "/";
+
+	TStopwatch watch;
+	int nrun = work_on_queue(queue);
+
+	cout << "\n------------------------\n";
+	cout << gSystem->HostName() << " " << gSystem->GetPid() << " ran " << nrun << " tasks in " << watch.RealTime() << "s\n";
+	cout << count_done(queue, queue_size(queue)) << " of " << queue_size(queue) << " tasks of \"" << queue << "\" are done";
+	cout << "\n------------------------\n";
+}
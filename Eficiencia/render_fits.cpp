@@ -0,0 +1,183 @@
+//Draws the png files of the fits saved by doFit with fit_plot_mode = "deferred"
+//Usage: root -l -b -q 'render_fits.cpp("results/bins_fit/efficiency/", false, 4)'
+#include "src/root_headers.h"
+#include "ROOT/TProcessExecutor.hxx"
+#include "src/dofits/fit_models.h"
+
+//Sets every parameter of the list with the values found in the fit result
+void set_parameters_from_fit(RooArgList& params, RooFitResult* fitres)
+{
+	for (RooAbsArg* arg : params)
+	{
+		RooRealVar* par     = (RooRealVar*)arg;
+		RooRealVar* fit_par = (RooRealVar*)fitres->floatParsFinal().find(par->GetName());
+		if (fit_par == NULL)
+			fit_par = (RooRealVar*)fitres->constPars().find(par->GetName());
+		if (fit_par == NULL)
+			continue;
+
+		par->setRange(fit_par->getMin(), fit_par->getMax());
+		par->setVal(fit_par->getVal());
+	}
+}
+
+//Draws one category (ALL or PASSING) of the fit and saves it as png
+void render_category(TH1* hist, RooRealVar& InvariantMass, RooAbsPdf& signal, RooAbsPdf& background, RooRealVar& n_signal, RooRealVar& n_back,
+	vector<const char*> components, const char* title, string png_path)
+{
+	RooDataHist data(hist->GetName(), hist->GetName(), RooArgList(InvariantMass), hist);
+	RooAddPdf   model("model", "model", RooArgList(signal, background), RooArgList(n_signal, n_back));
+	int component_colors[] = {kGreen, kMagenta - 5};
+
+	TCanvas* c1 = new TCanvas;
+	RooPlot* frame = InvariantMass.frame(RooFit::Title("Invariant Mass"));
+	frame->SetTitle(title);
+	frame->SetXTitle("#mu^{+}#mu^{-} invariant mass [GeV/c^{2}]");
+	data.plotOn(frame);
+
+	model.plotOn(frame);
+	for (size_t i = 0; i < components.size(); i++)
+		model.plotOn(frame,RooFit::Components(components[i]),RooFit::LineStyle(kDashed),RooFit::LineColor(component_colors[i%2]));
+	model.plotOn(frame,RooFit::Components("background"),RooFit::LineStyle(kDashed),RooFit::LineColor(kRed));
+
+	c1->cd();
+	frame->Draw();
+	c1->SaveAs(png_path.c_str());
+
+	delete frame;
+	delete c1;
+}
+
+//Builds the model of the fit with the same structs of doFit, sets its parameters from the fit result and draws both categories
+template <class Signal, class Background>
+void render_model(TH1* hist_all, TH1* hist_pass, RooFitResult* fitres, string base_path)
+{
+	//Same mass range and binning used on the fit
+	double _mmin = hist_all->GetXaxis()->GetXmin();
+	double _mmax = hist_all->GetXaxis()->GetXmax();
+	RooRealVar InvariantMass("InvariantMass", "InvariantMass", _mmin, _mmax);
+	InvariantMass.setBins(hist_all->GetNbinsX());
+
+	//SIGNAL AND BACKGROUND FUNCTIONS
+	RooRealVar mean("mean", "mean", 0.5*(_mmin + _mmax), _mmin, _mmax);
+	Signal     signal(InvariantMass, mean);
+	Background background(InvariantMass);
+
+	//YIELDS
+	RooRealVar n_signal_total("n_signal_total","n_signal_total",0.,0.,1e12);
+	RooRealVar n_signal_total_pass("n_signal_total_pass","n_signal_total_pass",0.,0.,1e12);
+	RooRealVar n_back("n_back","n_back",0.,0.,1e12);
+	RooRealVar n_back_pass("n_back_pass","n_back_pass",0.,0.,1e12);
+
+	RooArgSet* signal_params     = signal    .pdf.getParameters(RooArgSet(InvariantMass));
+	RooArgSet* background_params = background.pdf.getParameters(RooArgSet(InvariantMass));
+	RooArgList params(*signal_params);
+	params.add(*background_params);
+	params.add(RooArgList(n_signal_total, n_signal_total_pass, n_back, n_back_pass));
+	set_parameters_from_fit(params, fitres);
+
+	render_category(hist_all,  InvariantMass, signal.pdf, background.pdf, n_signal_total,      n_back,      signal.components(), "ALL",     base_path + "_ALL.png");
+	render_category(hist_pass, InvariantMass, signal.pdf, background.pdf, n_signal_total_pass, n_back_pass, signal.components(), "PASSING", base_path + "_PASS.png");
+
+	delete signal_params;
+	delete background_params;
+}
+
+//Draw function of each model name, with every combination of src/dofits/fit_models.h
+typedef void (*RenderFunction)(TH1* hist_all, TH1* hist_pass, RooFitResult* fitres, string base_path);
+map<string, RenderFunction> render_models;
+
+struct RenderModelRegistry
+{
+	template <class Signal, class Background>
+	void add()
+	{
+		render_models[fit_model_name<Signal, Background>()] = render_model<Signal, Background>;
+	}
+};
+
+bool register_render_models()
+{
+	RenderModelRegistry registry;
+	for_each_fit_model(registry);
+	return true;
+}
+bool render_models_registered = register_render_models();
+
+//Returns 1 if the snapshot was drawn, 0 if it was skipped
+int render_fit_snapshot(string snapshot_path, bool only_failed)
+{
+	TFile* file0 = TFile::Open(snapshot_path.c_str());
+	if (file0 == NULL || file0->IsZombie())
+	{
+		cerr << "Could not open \"" << snapshot_path << "\" file\n";
+		delete file0;
+		return 0;
+	}
+
+	RooFitResult* fitres     = (RooFitResult*)file0->Get("fitres");
+	TNamed*       model_name = (TNamed*)file0->Get("model");
+	TH1*          hist_all   = (TH1*)file0->Get("hist_all");
+	TH1*          hist_pass  = (TH1*)file0->Get("hist_pass");
+	if (fitres == NULL || model_name == NULL || hist_all == NULL || hist_pass == NULL)
+	{
+		cerr << "\"" << snapshot_path << "\" is not a fit snapshot\n";
+		delete file0;
+		return 0;
+	}
+
+	int rendered = 0;
+	if (render_models.find(model_name->GetTitle()) == render_models.end())
+		cerr << "\"" << snapshot_path << "\" has model \"" << model_name->GetTitle() << "\" that is not in src/dofits/fit_models.h\n";
+	else if (!only_failed || fitres->status() != 0)
+	{
+		//Same names used by doFit
+		string base_path = snapshot_path.substr(0, snapshot_path.length() - 5);
+		render_models[model_name->GetTitle()](hist_all, hist_pass, fitres, base_path);
+		rendered = 1;
+	}
+
+	delete fitres;
+	delete model_name;
+	delete file0;
+	return rendered;
+}
+
+//Looks for every snapshot (.root) in the folder and draws them using nworkers processes
+void render_fits(string folder = "results/bins_fit/efficiency/", bool only_failed = false, int nworkers = 4)
+{
+	gROOT->SetBatch(kTRUE);
+	RooMsgService::instance().setGlobalKillBelow(RooFit::WARNING);
+
+	if (folder.back() != '/')
+		folder += "/";
+
+	vector<string> snapshots;
+	void* dir = gSystem->OpenDirectory(folder.c_str());
+	if (dir == NULL)
+	{
+		cerr << "Could not open \"" << folder << "\" folder\n";
+		abort();
+	}
+	while (const char* entry = gSystem->GetDirEntry(dir))
+	{
+		string file_name = entry;
+		if (file_name.length() > 5 && file_name.substr(file_name.length() - 5) == ".root")
+			snapshots.push_back(folder + file_name);
+	}
+	gSystem->FreeDirectory(dir);
+
+	cout << "Found " << snapshots.size() << " fit snapshots in \"" << folder << "\"\n";
+
+	//Every worker is a separated process, so RooFit and graphics do not need to be thread safe
+	ROOT::TProcessExecutor pool(nworkers);
+	auto rendered = pool.Map([only_failed](string path) { return render_fit_snapshot(path, only_failed); }, snapshots);
+
+	int nrendered = 0;
+	for (int value : rendered)
+		nrendered += value;
+
+	cout << "\n------------------------\n";
+	cout << "Rendered: " << nrendered << " of " << snapshots.size() << " fits";
+	cout << "\n------------------------\n";
+}
@@ -1,14 +1,33 @@
 // Recreates DATA .root file as exactly fitting method uses
-void simplify_data()
-{
+//Usage: root -l -b -q 'simplify_data.cpp("fast")'
+//Modes:
+//"copy" reads and fills entry by entry (every basket is decompressed and compressed again)
+//"fast" copies the baskets of the used branches without unzipping them. AnalysisTree is kept as friend of the output tree
+//"view" copies nothing. The output tree only has the two source trees as friends and reads them on the source file
+//         Caches of the fits and columnar files check the source file too (data_file_sources in src/data_files.h)
+//Compression, basket and cluster sizes of the output are set in src/tree_output_settings.h
+#include "src/tree_output_settings.h"
 
-	TFile *file0  = TFile::Open("DATA/JPsiToMuMu_mergeMCNtuple.root");
-	TTree *TreeAT = (TTree*)file0->Get(("tagandprobe/AnalysisTree"));
-	TTree *TreePC = (TTree*)file0->Get(("tagandprobe/PlotControl"));
+//Change if you need
+const char* source_path = "DATA/JPsiToMuMu_mergeMCNtuple.root";
+const char* output_path = "DATA/TagAndProbe_Jpsi_Run2011_MC.root";
 
-	TFile *fileIO = TFile::Open("DATA/TagAndProbe_Jpsi_Run2011_MC.root","RECREATE");
+const char* PC_branches[] = {"ProbeMuon_Pt", "ProbeMuon_Eta", "ProbeMuon_Phi", "TagMuon_Pt", "TagMuon_Eta", "TagMuon_Phi"};
+const char* AT_branches[] = {"InvariantMass", "PassingProbeTrackingMuon", "PassingProbeStandAloneMuon", "PassingProbeGlobalMuon"};
+
+//Only the used branches are read or copied
+void select_branches(TTree* tree, const char** branches, int nbranches)
+{
+	tree->SetBranchStatus("*", 0);
+	for (int i = 0; i < nbranches; i++)
+		tree->SetBranchStatus(branches[i], 1);
+}
+
+void simplify_copy(TTree* TreeAT, TTree* TreePC, TFile* fileIO)
+{
+	fileIO->cd();
 	TTree *treeIO	 = new TTree("tagandprobe", "Tag And Probe");
-	
+
 	//Create variables
 	double ProbeMuon_Pt;
 	double ProbeMuon_Eta;
@@ -45,13 +64,15 @@ void simplify_data()
 	treeIO->Branch("PassingProbeStandAloneMuon",	&PassingProbeStandAloneMuon);
 	treeIO->Branch("PassingProbeGlobalMuon",		&PassingProbeGlobalMuon);
 
+	//Basket size only applies to branches that exist
+	configure_output_tree(treeIO);
+
 	long long numberEntries = TreePC->GetEntries();
 	//numberEntries = 1000;
 
 	//Prepare for showing progress
 	string progressFormat = "Progress: %05.2f%% %0"+to_string(strlen(to_string(numberEntries).data()))+"lld/%lld\r";
 	auto lastTime = std::chrono::steady_clock::now();
-	auto start    = std::chrono::steady_clock::now();
 
 	//Loop between the components
 	for (long long i = 0; i < numberEntries; i++)
@@ -60,8 +81,8 @@ void simplify_data()
 		TreePC->GetEntry(i);
 		TreeAT->GetEntry(i);
 
-		//Show progress on screen
-		if (chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - lastTime).count() >= 1000 || i == numberEntries - 1)
+		//Show progress on screen. The clock is only read every 4096 entries
+		if (((i & 4095) == 0 && chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - lastTime).count() >= 1000) || i == numberEntries - 1)
 		{
 			printf(progressFormat.data(), (float)(i+1)/(float)numberEntries*100, i+1, numberEntries);
 			lastTime = chrono::steady_clock::now();
@@ -77,3 +98,84 @@ void simplify_data()
 	cout << treeIO->GetEntries() << endl;
 	treeIO->Write("", TObject::kOverwrite);
 }
+
+void simplify_fast(TTree* TreeAT, TTree* TreePC, TFile* fileIO)
+{
+	select_branches(TreePC, PC_branches, sizeof(PC_branches)/sizeof(*PC_branches));
+	select_branches(TreeAT, AT_branches, sizeof(AT_branches)/sizeof(*AT_branches));
+
+	//Compressed baskets are copied as they are. With another compression they have to be unzipped and compressed again
+	fileIO->cd();
+	TTree* treeIO    = NULL;
+	TTree* treeIO_AT = NULL;
+	if (compression_algorithm == "")
+	{
+		treeIO    = TreePC->CloneTree(-1, "fast");
+		treeIO_AT = TreeAT->CloneTree(-1, "fast");
+	}
+	else
+	{
+		treeIO    = TreePC->CloneTree(0);
+		treeIO_AT = TreeAT->CloneTree(0);
+		configure_output_tree(treeIO);
+		configure_output_tree(treeIO_AT);
+		treeIO   ->CopyEntries(TreePC);
+		treeIO_AT->CopyEntries(TreeAT);
+	}
+	treeIO->SetName("tagandprobe");
+	treeIO->SetTitle("Tag And Probe");
+	treeIO_AT->SetName("tagandprobe_AnalysisTree");
+
+	//The friend is found by name on this same file when it is read
+	treeIO->AddFriend(treeIO_AT);
+
+	cout << "Numbers should match:\n";
+	cout << TreeAT->GetEntries() << endl;
+	cout << TreePC->GetEntries() << endl;
+	cout << treeIO_AT->GetEntries() << endl;
+	cout << treeIO->GetEntries() << endl;
+	treeIO_AT->Write("", TObject::kOverwrite);
+	treeIO   ->Write("", TObject::kOverwrite);
+}
+
+void simplify_view(TTree* TreeAT, TTree* TreePC, TFile* fileIO)
+{
+	//Tree without branches, with the entries of the source. Every branch comes from the friends on the source file
+	fileIO->cd();
+	TTree* treeIO = new TTree("tagandprobe", "Tag And Probe");
+	treeIO->SetEntries(TreePC->GetEntries());
+	treeIO->AddFriend("tagandprobe/PlotControl",  source_path);
+	treeIO->AddFriend("tagandprobe/AnalysisTree", source_path);
+
+	cout << "Numbers should match:\n";
+	cout << TreeAT->GetEntries() << endl;
+	cout << TreePC->GetEntries() << endl;
+	cout << treeIO->GetEntries() << endl;
+	cout << "\"" << output_path << "\" reads \"" << source_path << "\". Do not move or delete it\n";
+	treeIO->Write("", TObject::kOverwrite);
+}
+
+void simplify_data(string mode = "fast")
+{
+	auto start = std::chrono::steady_clock::now();
+
+	TFile *file0  = TFile::Open(source_path);
+	TTree *TreeAT = (TTree*)file0->Get(("tagandprobe/AnalysisTree"));
+	TTree *TreePC = (TTree*)file0->Get(("tagandprobe/PlotControl"));
+
+	enable_parallel_writing();
+	TFile *fileIO = open_output_file(output_path);
+	cout << "Writing \"" << output_path << "\" (" << output_settings_description() << ")\n";
+
+	if      (mode == "copy") simplify_copy(TreeAT, TreePC, fileIO);
+	else if (mode == "fast") simplify_fast(TreeAT, TreePC, fileIO);
+	else if (mode == "view") simplify_view(TreeAT, TreePC, fileIO);
+	else
+	{
+		cerr << "Unknown mode \"" << mode << "\". Use \"copy\", \"fast\" or \"view\"\n";
+		abort();
+	}
+
+	fileIO->Close();
+	cout << "Took " << chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count()/1000. << "s\n";
+}
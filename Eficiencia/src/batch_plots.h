@@ -0,0 +1,353 @@
+#ifndef BATCH_PLOTS_HEADER
+#define BATCH_PLOTS_HEADER
+//Every comparison plot of the efficiencies at once, instead of one quantity and Muon Id by run of Juntar.cpp, overplot_efficiencies.cpp or compare
+//Efficiencies are read from the results store (results_store.h) once and kept in memory, taking the last run of each one
+//Then for every quantity, Muon Id and variation it draws:
+//  the datasets overlaid with their ratio to the first one (data/MC), or its ratio map on 2D
+//  the variations of each dataset overlaid with their ratio to the first variation (1D with more than one variation)
+//Plots are drawn on batch mode by separated processes, so graphics do not need to be thread safe
+#include "ROOT/TProcessExecutor.hxx"
+#include "TLine.h"
+#include "TMultiGraph.h"
+#include "create_folder.h"
+#include "results_store.h"
+
+//Legend of each dataset. The others use their folder name
+map<string, string> dataset_labels = {
+	{"Jpsi_Run_2011", "J/#psi real data"},
+	{"Jpsi_MC_2020",  "Simulated data"}
+};
+
+//Axis title of each quantity
+map<string, string> quantity_titles = {
+	{"Pt",  "p_{T} (GeV/c)"},
+	{"Eta", "#eta"},
+	{"Phi", "#phi"}
+};
+
+//Colors of the curves, in order
+vector<int> batch_plot_colors = {kBlack, kRed, kGreen - 2, kBlue, kMagenta, kOrange, kCyan + 1, kViolet};
+
+//Efficiencies read from the store, by batch_key. 1D ones as graphs, 2D ones as histograms
+map<string, TGraphAsymmErrors*> batch_graphs;
+map<string, TH2D*>              batch_maps;
+
+string batch_key(string dataset, string quantity, string MuonId, string variation)
+{
+	return dataset + "/" + quantity + "_" + MuonId + "/" + variation;
+}
+
+//Last run of the store with the efficiency made by the macro of kind, -1 if there is none
+//The store does not keep the macro, but only plot_sys_efficiency.cpp and plot_sys_efficiency_2d.cpp record a "Final" efficiency with the variations
+int batch_run(const ResultsStore& store, string kind, string dataset, string quantity, string MuonId, string variation)
+{
+	vector<int> runs = result_runs(store, dataset, MuonId, quantity, variation);
+	bool systematic  = (kind != "efficiency");
+	for (int k = (int)runs.size() - 1; k >= 0; k--)
+		if (find_results(store, dataset, MuonId, quantity, "Final", runs[k]).empty() != systematic)
+			return runs[k];
+	return -1;
+}
+
+//Reads every efficiency from the results store, loaded once. Returns how many efficiencies were not found
+int load_batch_efficiencies(string kind, const vector<string>& datasets, const vector<string>& quantities, const vector<string>& muon_ids,
+	const vector<string>& variations)
+{
+	ResultsStore store = read_results();
+	if (store.records.empty())
+		cerr << "Could not find any result in \"" << results_store_path << "\"\n";
+
+	int nmissing = 0;
+	for (string dataset : datasets)
+		for (string quantity : quantities)
+			for (string MuonId : muon_ids)
+				for (string variation : variations)
+				{
+					string key = batch_key(dataset, quantity, MuonId, variation);
+					int    run = batch_run(store, kind, dataset, quantity, MuonId, variation);
+					if (run < 0)
+					{
+						cerr << "Could not find " << kind << " " << results_key(dataset, MuonId, quantity, variation) << " on the results store\n";
+						nmissing++;
+						continue;
+					}
+
+					//Bins without probes are left out of the graphs
+					vector<EfficiencyRecord> records = find_results(store, dataset, MuonId, quantity, variation, run);
+					bool is_map = false;
+					vector<EfficiencyRecord> filled;
+					for (const EfficiencyRecord& record : records)
+					{
+						is_map = is_map || record.yhigh > record.ylow;
+						if (record.yield_all > 0.)
+							filled.push_back(record);
+					}
+
+					if (!is_map)
+						batch_graphs[key] = results_graph(filled, key);
+					else if (TH2D* efficiency_map = results_map(records, key))
+						batch_maps[key] = efficiency_map;
+				}
+	return nmissing;
+}
+
+//One png of the batch
+struct BatchPlot
+{
+	string         title;
+	string         quantity;
+	vector<string> keys;                 //Efficiencies drawn, the first is the reference of the ratios
+	vector<string> labels;               //Legend of each one
+	string         ratio_title;
+	bool           reference_numerator;  //Ratio is reference/curve (data/MC) instead of curve/reference
+	string         png_path;
+};
+
+//Ratio of the points of two graphs with the same bins, with their errors added in quadrature
+TGraphAsymmErrors* ratio_graph(TGraphAsymmErrors* numerator, TGraphAsymmErrors* denominator)
+{
+	TGraphAsymmErrors* ratio = new TGraphAsymmErrors();
+	for (int i = 0; i < numerator->GetN(); i++)
+		for (int j = 0; j < denominator->GetN(); j++)
+		{
+			double x = numerator->GetX()[i];
+			if (fabs(x - denominator->GetX()[j]) > 1e-9*max(1., fabs(x)))
+				continue;
+
+			double value0 = numerator  ->GetY()[i];
+			double value1 = denominator->GetY()[j];
+			if (value0 <= 0. || value1 <= 0.)
+				break;
+
+			int    point = ratio->GetN();
+			double value = value0/value1;
+			double low   = value*sqrt(pow(numerator->GetErrorYlow (i)/value0, 2) + pow(denominator->GetErrorYhigh(j)/value1, 2));
+			double high  = value*sqrt(pow(numerator->GetErrorYhigh(i)/value0, 2) + pow(denominator->GetErrorYlow (j)/value1, 2));
+			ratio->SetPoint(point, x, value);
+			ratio->SetPointError(point, numerator->GetErrorXlow(i), numerator->GetErrorXhigh(i), low, high);
+			break;
+		}
+	return ratio;
+}
+
+//CMS Open Data label on the current pad
+void draw_open_data_label(double x, double y)
+{
+	TLatex* txCOD = new TLatex();
+	txCOD->SetTextSize(0.04);
+	txCOD->SetTextAlign(12);
+	txCOD->SetTextFont(42);
+	txCOD->SetNDC(kTRUE);
+	txCOD->DrawLatex(x, y, "#bf{CMS Open Data}");
+}
+
+//Overlay of 1D efficiencies with their ratios below. Returns 1 if it was saved
+int render_overlay(const BatchPlot& plot)
+{
+	string axis_title = quantity_titles.count(plot.quantity) ? quantity_titles[plot.quantity] : plot.quantity;
+
+	TCanvas* c1     = new TCanvas("c1", "c1", 800, 800);
+	TPad*    top    = new TPad("top",    "top",    0., 0.3, 1., 1.);
+	TPad*    bottom = new TPad("bottom", "bottom", 0., 0.,  1., 0.3);
+	top   ->SetMargin(0.10, 0.03, 0.02, 0.08);
+	bottom->SetMargin(0.10, 0.03, 0.30, 0.02);
+	if (plot.quantity == "Pt")
+	{
+		top   ->SetLogx();
+		bottom->SetLogx();
+	}
+	top   ->Draw();
+	bottom->Draw();
+
+	//Efficiencies
+	top->cd();
+	TMultiGraph* efficiencies = new TMultiGraph();
+	TLegend*     tl           = new TLegend(0.60, 0.10, 0.94, 0.10);
+	tl->SetTextSize(0.04);
+	for (size_t k = 0; k < plot.keys.size(); k++)
+	{
+		TGraphAsymmErrors* graph = batch_graphs[plot.keys[k]];
+		int color = batch_plot_colors[k % batch_plot_colors.size()];
+		graph->SetLineColor(color);
+		graph->SetMarkerColor(color);
+		graph->SetMarkerStyle(21);
+		graph->SetMarkerSize(0.5);
+		efficiencies->Add(graph, "P");
+		tl->AddEntry(graph, plot.labels[k].c_str(), "lp");
+	}
+	efficiencies->SetTitle((plot.title + ";;Efficiency").c_str());
+	efficiencies->Draw("A");
+	efficiencies->GetXaxis()->SetLabelSize(0.);
+	tl->SetY2(tl->GetY1() + tl->GetTextSize()*1.2*tl->GetNRows());
+	tl->Draw();
+	draw_open_data_label(0.14, 0.85);
+
+	//Ratios to the reference
+	bottom->cd();
+	TMultiGraph* ratios = new TMultiGraph();
+	TGraphAsymmErrors* reference = batch_graphs[plot.keys[0]];
+	for (size_t k = 1; k < plot.keys.size(); k++)
+	{
+		TGraphAsymmErrors* graph = batch_graphs[plot.keys[k]];
+		TGraphAsymmErrors* ratio = plot.reference_numerator ? ratio_graph(reference, graph) : ratio_graph(graph, reference);
+		int color = batch_plot_colors[k % batch_plot_colors.size()];
+		ratio->SetLineColor(color);
+		ratio->SetMarkerColor(color);
+		ratio->SetMarkerStyle(21);
+		ratio->SetMarkerSize(0.5);
+		ratios->Add(ratio, "P");
+	}
+	ratios->SetTitle((";" + axis_title + ";" + plot.ratio_title).c_str());
+	ratios->Draw("A");
+	ratios->GetXaxis()->SetLimits(efficiencies->GetXaxis()->GetXmin(), efficiencies->GetXaxis()->GetXmax());
+	ratios->GetXaxis()->SetTitleSize(0.12);
+	ratios->GetXaxis()->SetLabelSize(0.10);
+	ratios->GetYaxis()->SetTitleSize(0.10);
+	ratios->GetYaxis()->SetTitleOffset(0.45);
+	ratios->GetYaxis()->SetLabelSize(0.08);
+	ratios->GetYaxis()->SetNdivisions(505);
+
+	TLine* one = new TLine(efficiencies->GetXaxis()->GetXmin(), 1., efficiencies->GetXaxis()->GetXmax(), 1.);
+	one->SetLineStyle(kDashed);
+	one->Draw();
+
+	c1->SaveAs(plot.png_path.c_str());
+	delete c1;
+	return 1;
+}
+
+//Ratio map of two 2D efficiencies. Returns 1 if it was saved
+int render_ratio_map(const BatchPlot& plot)
+{
+	TH2D* ratio = (TH2D*)batch_maps[plot.keys[0]]->Clone("ratio");
+	ratio->Divide(batch_maps[plot.keys[1]]);
+	ratio->SetTitle((plot.title + " (" + plot.ratio_title + ")").c_str());
+
+	TCanvas* c1 = new TCanvas("c1", "c1", 1280, 900);
+	c1->cd();
+	gStyle->SetOptStat(0);
+	ratio->Draw("colztexte");
+	c1->SetLogx();
+
+	c1->SaveAs(plot.png_path.c_str());
+	delete c1;
+	return 1;
+}
+
+int render_batch_plot(const BatchPlot& plot)
+{
+	for (string key : plot.keys)
+		if (batch_graphs.find(key) == batch_graphs.end() && batch_maps.find(key) == batch_maps.end())
+			return 0;
+
+	if (batch_maps.find(plot.keys[0]) != batch_maps.end())
+		return render_ratio_map(plot);
+	return render_overlay(plot);
+}
+
+string dataset_label(string dataset)
+{
+	return dataset_labels.count(dataset) ? dataset_labels[dataset] : dataset;
+}
+
+//Plots of the matrix dataset x quantity x Muon Id x variation. The first dataset is the reference of the data/MC ratios
+vector<BatchPlot> batch_plot_list(string kind, const vector<string>& datasets, const vector<string>& quantities, const vector<string>& muon_ids,
+	const vector<string>& variations, string output_folder)
+{
+	vector<BatchPlot> plots;
+	for (string quantity : quantities)
+		for (string MuonId : muon_ids)
+		{
+			//Datasets compared on each variation
+			for (string variation : variations)
+			{
+				bool is_map = batch_maps.count(batch_key(datasets[0], quantity, MuonId, variation)) > 0;
+				for (size_t d = 1; d < datasets.size(); d++)
+				{
+					//Maps have only one ratio each, overlays have every dataset
+					if (!is_map && d > 1)
+						break;
+
+					BatchPlot plot;
+					plot.title               = "Efficiency for " + MuonId + " (" + variation + ")";
+					plot.quantity            = quantity;
+					plot.ratio_title         = dataset_label(datasets[0]) + "/" + (is_map || datasets.size() == 2 ? dataset_label(datasets[d]) : "dataset");
+					plot.reference_numerator = true;
+					plot.png_path            = output_folder + quantity + "_" + MuonId + "_" + variation + "_" + datasets[0] + "_vs_" +
+						(is_map ? datasets[d] : "datasets") + ".png";
+					for (size_t k = 0; k < datasets.size(); k++)
+						if (!is_map || k == 0 || k == d)
+						{
+							plot.keys  .push_back(batch_key(datasets[k], quantity, MuonId, variation));
+							plot.labels.push_back(dataset_label(datasets[k]));
+						}
+					plots.push_back(plot);
+				}
+			}
+
+			//Variations of each dataset, like overplot_efficiencies.cpp
+			if (variations.size() < 2)
+				continue;
+			for (string dataset : datasets)
+			{
+				if (batch_maps.count(batch_key(dataset, quantity, MuonId, variations[0])) > 0)
+					continue;
+
+				BatchPlot plot;
+				plot.title               = "Efficiency for " + MuonId + " (" + dataset_label(dataset) + ")";
+				plot.quantity            = quantity;
+				plot.ratio_title         = "Variation/" + variations[0];
+				plot.reference_numerator = false;
+				plot.png_path            = output_folder + quantity + "_" + MuonId + "_" + dataset + "_variations.png";
+				for (string variation : variations)
+				{
+					plot.keys  .push_back(batch_key(dataset, quantity, MuonId, variation));
+					plot.labels.push_back(variation);
+				}
+				plots.push_back(plot);
+			}
+		}
+	return plots;
+}
+
+//Reads the efficiencies of kind ("efficiency", "systematic_1D" or "systematic_2D") and draws every plot with nworkers processes
+void batch_plots(string kind, const vector<string>& datasets, const vector<string>& quantities, const vector<string>& muon_ids,
+	const vector<string>& variations, string output_folder = "results/comparisons/", int nworkers = 4)
+{
+	gROOT->SetBatch(kTRUE);
+	if (datasets.empty() || variations.empty())
+	{
+		cerr << "Batch plots need at least one dataset and one variation\n";
+		abort();
+	}
+
+	if (output_folder.back() != '/')
+		output_folder += "/";
+	output_folder += kind + "/";
+	create_folder(output_folder.c_str());
+
+	TStopwatch watch;
+	int nmissing = load_batch_efficiencies(kind, datasets, quantities, muon_ids, variations);
+	vector<BatchPlot> plots = batch_plot_list(kind, datasets, quantities, muon_ids, variations, output_folder);
+	cout << "Read " << batch_graphs.size() + batch_maps.size() << " efficiencies (" << nmissing << " missing) in " << watch.RealTime() << "s\n";
+
+	//Workers are forked after the efficiencies are read, so each one has them without reading the files again
+	watch.Start();
+	int nrendered = 0;
+	if (nworkers <= 1)
+		for (const BatchPlot& plot : plots)
+			nrendered += render_batch_plot(plot);
+	else
+	{
+		ROOT::TProcessExecutor pool(nworkers);
+		auto rendered = pool.Map([](BatchPlot plot) { return render_batch_plot(plot); }, plots);
+		for (int value : rendered)
+			nrendered += value;
+	}
+
+	cout << "\n------------------------\n";
+	cout << "Plots: " << nrendered << " of " << plots.size() << " in " << watch.RealTime() << "s (the others miss an efficiency)\n";
+	cout << "Output: " << output_folder;
+	cout << "\n------------------------\n";
+}
+#endif
@@ -0,0 +1,64 @@
+#ifndef BIN_EDGES_HEADER
+#define BIN_EDGES_HEADER
+//Text file with bin edges, as written by adaptive_binning.cpp
+//One line per quantity: the name followed by the edges. Lines starting with # are comments
+//Pt 0 3.4 4 5 6 8 40
+#include <fstream>
+#include <sstream>
+
+//Edges of quantity in the file
+vector<double> read_bins(string path, string quantity)
+{
+	ifstream file(path);
+	if (!file)
+	{
+		cerr << "Could not open \"" << path << "\" bins file\n";
+		abort();
+	}
+
+	string line;
+	while (getline(file, line))
+	{
+		stringstream fields(line);
+		string name;
+		if (!(fields >> name) || name[0] == '#' || name != quantity)
+			continue;
+
+		vector<double> edges;
+		double edge;
+		while (fields >> edge)
+			edges.push_back(edge);
+
+		if (edges.size() < 2 || !is_sorted(edges.begin(), edges.end()))
+		{
+			cerr << "Edges of " << quantity << " on \"" << path << "\" have to be at least two and increasing\n";
+			abort();
+		}
+		return edges;
+	}
+
+	cerr << "No edges of " << quantity << " on \"" << path << "\"\n";
+	abort();
+}
+
+//Writes the edges of each quantity. Returns false if it could not be written
+bool write_bins(string path, string comment, const vector<string>& quantities, const vector<vector<double>>& edges)
+{
+	ofstream file(path);
+	if (!file)
+	{
+		cerr << "Could not write \"" << path << "\" bins file\n";
+		return false;
+	}
+
+	file << "#" << comment << "\n";
+	for (size_t q = 0; q < quantities.size(); q++)
+	{
+		file << quantities[q];
+		for (double edge : edges[q])
+			file << " " << edge;
+		file << "\n";
+	}
+	return true;
+}
+#endif
@@ -0,0 +1,215 @@
+#ifndef BIN_HISTOGRAMS_HEADER
+#define BIN_HISTOGRAMS_HEADER
+//Invariant mass histograms of ALL and PASSING probes of a bin, as doFit fits them
+//On incremental mode every file keeps its own histograms of every bin on disk (partials), and a bin is the sum of them
+//When files are added only the new ones are read, and only bins where the sum changed miss the fit cache
+#include "TMD5.h"
+
+#include "probe_selection.h"
+
+//Set it true to keep partial histograms per file and fit only the bins changed by new files
+bool use_incremental_partials = false;
+
+//Folder of the partial histograms. Each file has one .root file there with the histograms of every bin it was used
+string partials_folder = "results/partials/";
+
+//Number of invariant mass bins of the fit. RooRealVar uses 100 while fit_bins is not set
+int mass_bins()
+{
+	return (fit_bins > 0) ? fit_bins : 100;
+}
+
+string md5_of(string text)
+{
+	TMD5 md5;
+	md5.Update((const UChar_t*)text.data(), text.size());
+	md5.Final();
+	return md5.AsString();
+}
+
+//Partials of a file: histograms ALL and PASSING by md5 of the bin condition
+struct FilePartials
+{
+	string path;
+	map<string, pair<TH1*, TH1*>> bins;
+};
+
+//Partials already loaded, by path of their file
+map<string, FilePartials*> loaded_partials;
+
+//Partials of a data file. They depend on the file itself, the sources it reads (data_files.h) and on everything that selects or bins the probes
+FilePartials* file_partials(string data_file, string MuonId)
+{
+	FileStat_t data_stat;
+	if (gSystem->GetPathInfo(data_file.c_str(), data_stat) != 0)
+	{
+		cerr << "Could not find \"" << data_file << "\" file\n";
+		abort();
+	}
+
+	string description;
+	description += "data: "      + data_file_identity(data_file) + "\n";
+	description += string("probes: ") + tag_cut + " && " + probe_ranges + " && " + MuonId + " (edges in float)\n";
+	description += "fit range: " + to_string(_mmin) + " " + to_string(_mmax) + "\n";
+	description += "fit bins: "  + to_string(mass_bins()) + "\n";
+	string path = partials_folder + md5_of(description) + ".root";
+
+	auto found = loaded_partials.find(path);
+	if (found != loaded_partials.end())
+		return found->second;
+
+	FilePartials* partials = new FilePartials;
+	partials->path = path;
+
+	TDirectory* previous_dir = gDirectory;
+	TFile* partials_file = gSystem->AccessPathName(path.c_str()) ? NULL : TFile::Open(path.c_str());
+	previous_dir->cd();
+	if (partials_file != NULL && !partials_file->IsZombie())
+	{
+		for (TObject* key : *partials_file->GetListOfKeys())
+		{
+			string name = key->GetName();
+			if (name.substr(0, 4) != "all_")
+				continue;
+
+			string bin  = name.substr(4);
+			TH1* hist_all  = (TH1*)partials_file->Get(("all_"  + bin).c_str());
+			TH1* hist_pass = (TH1*)partials_file->Get(("pass_" + bin).c_str());
+			if (hist_all == NULL || hist_pass == NULL)
+			{
+				delete hist_all;
+				delete hist_pass;
+				continue;
+			}
+
+			hist_all ->SetDirectory(0);
+			hist_pass->SetDirectory(0);
+			partials->bins[bin] = make_pair(hist_all, hist_pass);
+		}
+	}
+	delete partials_file;
+
+	loaded_partials[path] = partials;
+	return partials;
+}
+
+//Appends the histograms of a bin to the partials file right away, so an interrupted run keeps what was already done
+void write_bin_partials(const FilePartials* partials, TH1* hist_all, TH1* hist_pass)
+{
+	if (gSystem->AccessPathName(partials_folder.c_str()))
+		gSystem->mkdir(partials_folder.c_str(), true);
+	TDirectory* previous_dir = gDirectory;
+	TFile* partials_file = TFile::Open(partials->path.c_str(), "UPDATE");
+	if (partials_file != NULL && !partials_file->IsZombie())
+	{
+		hist_all ->Write(hist_all ->GetName(), TObject::kOverwrite);
+		hist_pass->Write(hist_pass->GetName(), TObject::kOverwrite);
+	}
+	else
+		cerr << "Could not write \"" << partials->path << "\" file. Partials of this bin will be made again next run\n";
+	delete partials_file;
+	previous_dir->cd();
+}
+
+//Makes the histograms of one bin for files that never had them
+//The files are loaded and selected together as one dataset and filled one file per thread
+//Histograms are created, stored and written on this thread, since neither the maps of partials nor ROOT files are thread safe
+void make_bin_partials(const vector<string>& data_files, string condition, string MuonId)
+{
+	string files_path;
+	for (string data_file : data_files)
+		files_path += (files_path.empty() ? "" : ",") + data_file;
+
+	const ProbeDataset& dataset = load_probe_dataset(files_path.c_str());
+	if (dataset.size() != data_files.size())
+	{
+		cerr << "\"" << files_path << "\" does not expand to one file by path\n";
+		abort();
+	}
+	const DatasetSelection& selected = select_bin_probes(files_path.c_str(), condition);
+	int bit = passing_bit(MuonId);
+
+	string bin = md5_of(condition);
+	vector<TH1*> hists_all, hists_pass;
+	for (size_t f = 0; f < data_files.size(); f++)
+	{
+		hists_all .push_back(new TH1D(("all_"  + bin).c_str(), condition.c_str(), mass_bins(), _mmin, _mmax));
+		hists_pass.push_back(new TH1D(("pass_" + bin).c_str(), condition.c_str(), mass_bins(), _mmin, _mmax));
+		hists_all [f]->SetDirectory(0);
+		hists_pass[f]->SetDirectory(0);
+	}
+
+	for_each_file(dataset.size(), [&](unsigned f)
+	{
+		fill_file_mass_histograms(*dataset[f], selected[f], bit, hists_all[f], hists_pass[f]);
+	});
+
+	for (size_t f = 0; f < data_files.size(); f++)
+	{
+		FilePartials* partials = file_partials(data_files[f], MuonId);
+		partials->bins[bin] = make_pair(hists_all[f], hists_pass[f]);
+		write_bin_partials(partials, hists_all[f], hists_pass[f]);
+	}
+}
+
+//Deletes the partials loaded so far. They are read again from their files when needed
+void release_partials()
+{
+	for (auto& loaded : loaded_partials)
+	{
+		for (auto& bin : loaded.second->bins)
+		{
+			delete bin.second.first;
+			delete bin.second.second;
+		}
+		delete loaded.second;
+	}
+	loaded_partials.clear();
+}
+
+//Fills the histograms of the bin, summing partials on incremental mode or selecting every probe otherwise
+void fill_bin_histograms(const char* data_path, string condition, string MuonId, TH1* hist_all, TH1* hist_pass)
+{
+	if (!use_incremental_partials)
+	{
+		fill_mass_histograms(load_probe_dataset(data_path), select_bin_probes(data_path, condition), passing_bit(MuonId), hist_all, hist_pass);
+		return;
+	}
+
+	//Only files without histograms of this bin are read
+	string bin = md5_of(condition);
+	vector<FilePartials*> partials;
+	vector<string>        missing_files;
+	for (string data_file : expand_data_files(data_path))
+	{
+		partials.push_back(file_partials(data_file, MuonId));
+		if (partials.back()->bins.count(bin) == 0 && find(missing_files.begin(), missing_files.end(), data_file) == missing_files.end())
+			missing_files.push_back(data_file);
+	}
+	if (!missing_files.empty())
+		make_bin_partials(missing_files, condition, MuonId);
+
+	for (FilePartials* file : partials)
+	{
+		hist_all ->Add(file->bins[bin].first);
+		hist_pass->Add(file->bins[bin].second);
+	}
+}
+
+//On incremental mode the fit cache depends on the content of the histograms, not on the list of files
+//So a bin where new files have no probes keeps its cached fit
+string bin_histograms_description(const char* data_path, string condition, string MuonId)
+{
+	TH1D hist_all ("description_all",  "", mass_bins(), _mmin, _mmax);
+	TH1D hist_pass("description_pass", "", mass_bins(), _mmin, _mmax);
+	hist_all .SetDirectory(0);
+	hist_pass.SetDirectory(0);
+	fill_bin_histograms(data_path, condition, MuonId, &hist_all, &hist_pass);
+
+	TMD5 md5;
+	md5.Update((const UChar_t*)hist_all .GetArray(), hist_all .GetSize()*sizeof(double));
+	md5.Update((const UChar_t*)hist_pass.GetArray(), hist_pass.GetSize()*sizeof(double));
+	md5.Final();
+	return string("histograms: ") + md5.AsString() + "\n";
+}
+#endif
@@ -0,0 +1,73 @@
+#ifndef CHECKPOINT_HEADER
+#define CHECKPOINT_HEADER
+//Journal of finished fits, so a long scan can be resumed after a crash
+//Every fit appends a line as soon as it ends: yield_all yield_pass err_all err_pass, a tab and the key of the fit
+//A line cut by a crash has no key and is ignored on resume
+#include <unistd.h>
+
+typedef map<string, YieldsNErrs> Checkpoint;
+
+//Everything that changes the result of a fit: data, tag selection, fit settings, the bin and the Muon Id
+//Data is identified by the path, size and modification time of its files and their sources, as in the fit cache,
+//so fits of files that were replaced are not resumed
+string checkpoint_key(string model, double mmin, double mmax, int nbins, string condition, string MuonId)
+{
+	//Files are only looked up again when the data path changes
+	static string data_path, data_identity;
+	if (data_path != data_file_path)
+	{
+		data_path     = data_file_path;
+		data_identity = data_path_identity(data_path);
+	}
+
+	char settings[256];
+	snprintf(settings, sizeof(settings), "%s %.6g %.6g %d", model.c_str(), mmin, mmax, nbins);
+	return data_identity + " | " + tag_cut + " | " + probe_ranges + " | " + settings + " | " + condition + " | " + MuonId;
+}
+
+//Fits stored in the journal. Returns an empty checkpoint if there is no journal
+Checkpoint read_checkpoint(string path)
+{
+	Checkpoint checkpoint;
+	FILE* file = fopen(path.c_str(), "r");
+	if (file == NULL)
+		return checkpoint;
+
+	char* line = NULL;
+	size_t size = 0;
+	while (getline(&line, &size, file) != -1)
+	{
+		YieldsNErrs yields;
+		int key_start = 0;
+		if (sscanf(line, "%lf %lf %lf %lf\t%n", &yields[0], &yields[1], &yields[2], &yields[3], &key_start) != 4 || key_start == 0)
+			continue;
+
+		string key = line + key_start;
+		if (key.empty() || key.back() != '\n')
+			continue;
+		key.pop_back();
+		checkpoint[key] = yields;
+	}
+
+	free(line);
+	fclose(file);
+	return checkpoint;
+}
+
+//Appends a finished fit and waits until it is on disk
+//The line goes in a single write to a file opened for appending, so the worker processes of run_variations share the journal
+void append_checkpoint(string path, string key, const YieldsNErrs& yields_n_errs)
+{
+	FILE* file = fopen(path.c_str(), "a");
+	if (file == NULL)
+	{
+		cerr << "Could not write \"" << path << "\" checkpoint\n";
+		abort();
+	}
+
+	fprintf(file, "%.17g %.17g %.17g %.17g\t%s\n", yields_n_errs[0], yields_n_errs[1], yields_n_errs[2], yields_n_errs[3], key.c_str());
+	fflush(file);
+	fsync(fileno(file));
+	fclose(file);
+}
+#endif
@@ -1,3 +1,5 @@
+#ifndef COMPARE_EFFICIENCY_HEADER
+#define COMPARE_EFFICIENCY_HEADER
 /*
 !--------------------------------
 !Purpose: Compare efficiency of two .root files
@@ -154,4 +156,5 @@ void compare_efficiency(string muon_id, string quantity, string run2011, string
     string path = muon_id + "_" + quantity + "_Efficiency";
 
     compare_plot(file0, file1, path.c_str(), quantity);
-}
\ No newline at end of file
+}
+#endif
@@ -0,0 +1,142 @@
+#ifndef CUT_AND_COUNT_HEADER
+#define CUT_AND_COUNT_HEADER
+//Efficiency without fitting: probes are counted in a signal window and the background under it is estimated from the sidebands
+//The background is taken as linear between the centers of the two sidebands, so they do not need to have the same width
+#include "probe_selection.h"
+
+//Regions of InvariantMass. Sidebands should be inside the fit range (_mmin, _mmax)
+double signal_window [2] = {3.00, 3.20};
+double sideband_left [2] = {2.80, 2.95};
+double sideband_right[2] = {3.25, 3.30};
+
+//Counts of one bin as [sample][region]. Sample 0 is ALL and 1 is PASSING. Region 0 is the window, 1 the left and 2 the right sideband
+struct SidebandCounts
+{
+	double n[2][3];
+};
+
+//Signal on the window and its error for counts of one sample {window, left, right}
+void sideband_subtraction(const double* n, double& signal, double& error)
+{
+	double width_window = signal_window [1] - signal_window [0];
+	double width_left   = sideband_left [1] - sideband_left [0];
+	double width_right  = sideband_right[1] - sideband_right[0];
+
+	//Linear background through the densities at the sideband centers, integrated over the window
+	double center_left   = (sideband_left [0] + sideband_left [1])/2.;
+	double center_right  = (sideband_right[0] + sideband_right[1])/2.;
+	double center_window = (signal_window [0] + signal_window [1])/2.;
+	double weight_right  = (center_window - center_left)/(center_right - center_left);
+	double weight_left   = 1. - weight_right;
+
+	double coef_left  = width_window*weight_left /width_left;
+	double coef_right = width_window*weight_right/width_right;
+
+	signal = n[0] - coef_left*n[1] - coef_right*n[2];
+	error  = sqrt(n[0] + coef_left*coef_left*n[1] + coef_right*coef_right*n[2]);
+}
+
+//Efficiency and its error from the counts of a bin. Failing probes are independent from passing ones, so both are subtracted apart
+void sideband_efficiency(const SidebandCounts& counts, double& efficiency, double& error)
+{
+	double fail[3];
+	for (int region = 0; region < 3; region++)
+		fail[region] = counts.n[0][region] - counts.n[1][region];
+
+	double signal_pass, error_pass, signal_fail, error_fail;
+	sideband_subtraction(counts.n[1], signal_pass, error_pass);
+	sideband_subtraction(fail,        signal_fail, error_fail);
+
+	double total = signal_pass + signal_fail;
+	if (total <= 0.)
+	{
+		efficiency = 0.;
+		error      = 0.;
+		return;
+	}
+
+	efficiency = signal_pass/total;
+	error      = sqrt(signal_fail*signal_fail*error_pass*error_pass + signal_pass*signal_pass*error_fail*error_fail)/(total*total);
+}
+
+//Region of a mass: 0 window, 1 left, 2 right or -1 if it is on none
+inline int mass_region(float mass)
+{
+	if (mass >= signal_window [0] && mass < signal_window [1]) return 0;
+	if (mass >= sideband_left [0] && mass < sideband_left [1]) return 1;
+	if (mass >= sideband_right[0] && mass < sideband_right[1]) return 2;
+	return -1;
+}
+
+//Column of the probe quantity
+const float* quantity_column(const ProbeColumns& columns, string quantity)
+{
+	if      (quantity == "Pt")  return columns.ProbeMuon_Pt;
+	else if (quantity == "Eta") return columns.ProbeMuon_Eta;
+	else if (quantity == "Phi") return columns.ProbeMuon_Phi;
+
+	cerr << "Unknown quantity \"" << quantity << "\". Use \"Pt\", \"Eta\" or \"Phi\"\n";
+	abort();
+}
+
+//Counts every cell of a grid of xquantity and yquantity in a single pass over the probes that pass the tag selection
+//Bin i is [edges[i], edges[i+1]), as the conditions of the efficiency macros. abs_y uses |yquantity|, as plot_sys_efficiency_2d.cpp
+//Cell (i, j) is at i*nbinsy + j. Without yquantity there is a single y bin
+vector<SidebandCounts> count_on_grid(const char* data_path, string MuonId, string xquantity, const vector<double>& xbins,
+	string yquantity = "", const vector<double>& ybins = {}, bool abs_y = false)
+{
+	const ProbeDataset&     dataset  = load_probe_dataset(data_path);
+	const DatasetSelection& selected = select_bin_probes(data_path, "1");
+	int bit = passing_bit(MuonId);
+
+	int nbinsx = xbins.size() - 1;
+	int nbinsy = (yquantity == "") ? 1 : ybins.size() - 1;
+
+	//Edges in float, as the conditions of the fits (see float_literals)
+	vector<double> xedges = float_edges(xbins);
+	vector<double> yedges = float_edges(ybins);
+
+	vector<const float*> xvalues(dataset.size()), yvalues(dataset.size(), NULL);
+	for (size_t f = 0; f < dataset.size(); f++)
+	{
+		xvalues[f] = quantity_column(*dataset[f], xquantity);
+		if (yquantity != "")
+			yvalues[f] = quantity_column(*dataset[f], yquantity);
+	}
+
+	//Each file counts on its own thread
+	vector<vector<SidebandCounts>> file_counts(dataset.size(), vector<SidebandCounts>(nbinsx*nbinsy, SidebandCounts{}));
+	for_each_file(dataset.size(), [&](unsigned f)
+	{
+		const ProbeColumns& columns = *dataset[f];
+		for (unsigned i : selected[f])
+		{
+			int region = mass_region(columns.InvariantMass[i]);
+			double x   = xvalues[f][i];
+			if (region < 0 || x < xedges[0] || x >= xedges[nbinsx])
+				continue;
+
+			int bin = upper_bound(xedges.begin(), xedges.end(), x) - xedges.begin() - 1;
+			if (yvalues[f] != NULL)
+			{
+				double y = abs_y ? fabs(yvalues[f][i]) : yvalues[f][i];
+				if (y < yedges[0] || y >= yedges[nbinsy])
+					continue;
+				bin = bin*nbinsy + (upper_bound(yedges.begin(), yedges.end(), y) - yedges.begin() - 1);
+			}
+
+			file_counts[f][bin].n[0][region] += 1.;
+			file_counts[f][bin].n[1][region] += probe_passing(columns.passing[bit], i);
+		}
+	});
+
+	vector<SidebandCounts> counts(nbinsx*nbinsy, SidebandCounts{});
+	for (size_t f = 0; f < dataset.size(); f++)
+		for (int bin = 0; bin < nbinsx*nbinsy; bin++)
+			for (int sample = 0; sample < 2; sample++)
+				for (int region = 0; region < 3; region++)
+					counts[bin].n[sample][region] += file_counts[f][bin].n[sample][region];
+
+	return counts;
+}
+#endif
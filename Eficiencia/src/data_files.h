@@ -0,0 +1,145 @@
+#ifndef DATA_FILES_HEADER
+#define DATA_FILES_HEADER
+//Input of doFit can be one file, a glob pattern like "DATA/Run2011/*.root", several of them separated by commas
+//or a .txt file listing them (one per line, lines starting with # are ignored)
+#include <glob.h>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+
+#include "TFriendElement.h"
+
+vector<string> expand_data_files(string data_path)
+{
+	vector<string> files;
+
+	stringstream paths(data_path);
+	string path;
+	while (getline(paths, path, ','))
+	{
+		//Spaces around the commas
+		size_t first = path.find_first_not_of(" \t");
+		size_t last  = path.find_last_not_of(" \t");
+		if (first == string::npos)
+			continue;
+		path = path.substr(first, last - first + 1);
+
+		if (path.size() > 4 && path.substr(path.size() - 4) == ".txt")
+		{
+			ifstream list(path);
+			if (!list)
+			{
+				cerr << "Could not open \"" << path << "\" file list\n";
+				abort();
+			}
+
+			string line;
+			while (getline(list, line))
+			{
+				if (line.find_first_not_of(" \t") == string::npos || line[line.find_first_not_of(" \t")] == '#')
+					continue;
+				for (string file : expand_data_files(line))
+					files.push_back(file);
+			}
+		}
+		else if (path.find_first_of("*?[") != string::npos)
+		{
+			glob_t matches;
+			if (glob(path.c_str(), 0, NULL, &matches) != 0)
+			{
+				cerr << "No file matches \"" << path << "\"\n";
+				abort();
+			}
+			for (size_t i = 0; i < matches.gl_pathc; i++)
+				files.push_back(matches.gl_pathv[i]);
+			globfree(&matches);
+		}
+		else
+			files.push_back(path);
+	}
+
+	if (files.empty())
+	{
+		cerr << "No data file in \"" << data_path << "\"\n";
+		abort();
+	}
+
+	return files;
+}
+
+//Files a data file reads its probes from: itself and the files of the friends of its tree
+//A "view" file of simplify_data.cpp has no data, every branch is read from its source file
+//Read once by path. Files can be opened from several threads (probe_columns.h)
+vector<string> data_file_sources(string data_file)
+{
+	static map<string, vector<string>> sources;
+	static mutex sources_mutex;
+	lock_guard<mutex> lock(sources_mutex);
+
+	auto found = sources.find(data_file);
+	if (found != sources.end())
+		return found->second;
+
+	vector<string> files = {data_file};
+	FileStat_t data_stat;
+	gSystem->GetPathInfo(data_file.c_str(), data_stat);
+
+	TDirectory* previous_dir = gDirectory;
+	TFile* file = TFile::Open(data_file.c_str());
+	previous_dir->cd();
+	if (file != NULL && !file->IsZombie())
+	{
+		TTree* tree = (TTree*)file->Get("tagandprobe");
+		if (tree != NULL && tree->GetListOfFriends() != NULL)
+			for (TObject* object : *tree->GetListOfFriends())
+			{
+				//Friends on the same file ("fast" mode) have no file name or the name of this file
+				string friend_file = ((TFriendElement*)object)->GetTitle();
+				FileStat_t friend_stat;
+				bool same_file = gSystem->GetPathInfo(friend_file.c_str(), friend_stat) == 0
+					&& friend_stat.fDev == data_stat.fDev && friend_stat.fIno == data_stat.fIno;
+				if (friend_file != "" && !same_file && find(files.begin(), files.end(), friend_file) == files.end())
+					files.push_back(friend_file);
+			}
+	}
+	delete file;
+
+	sources[data_file] = files;
+	return files;
+}
+
+//Path, size and modification time of a data file and of its sources. It changes when any of them is replaced
+string data_file_identity(string data_file)
+{
+	string identity;
+	for (string source : data_file_sources(data_file))
+	{
+		FileStat_t source_stat;
+		gSystem->GetPathInfo(source.c_str(), source_stat);
+		identity += (identity != "" ? ", " : "") + source + " " + to_string(source_stat.fSize) + " " + to_string(source_stat.fMtime);
+	}
+	return identity;
+}
+
+//Identity of every file of a data path (see expand_data_files)
+string data_path_identity(string data_path)
+{
+	string identity;
+	for (string data_file : expand_data_files(data_path))
+		identity += (identity != "" ? ", " : "") + data_file_identity(data_file);
+	return identity;
+}
+
+//Latest modification time of a data file and of its sources
+long data_file_mtime(string data_file)
+{
+	long mtime = 0;
+	for (string source : data_file_sources(data_file))
+	{
+		FileStat_t source_stat;
+		if (gSystem->GetPathInfo(source.c_str(), source_stat) == 0)
+			mtime = max(mtime, source_stat.fMtime);
+	}
+	return mtime;
+}
+#endif
@@ -0,0 +1,231 @@
+#ifndef DOFIT_TEMPLATE_HEADER
+#define DOFIT_TEMPLATE_HEADER
+//Fit of a bin for any signal model, background model and dataset
+//Include it through DoFit_Jpsi_Run.h or DoFit_Jpsi_MC.h, which choose the Dataset
+#include "datasets.h"
+#include "fit_models.h"
+
+//We start by declaring the nature of our dataset. (Is the data real or simulated?)
+const char* output_folder_name = Dataset::output_folder_name;
+
+//Input files (one path, glob pattern, comma separated paths or .txt list) and selection of the tag muon
+const char* data_file_path = Dataset::data_file_path;
+const char* tag_cut = Dataset::tag_cut;
+
+//Header of this function
+double _mmin = Dataset::mmin;
+double _mmax = Dataset::mmax;
+double fit_bins = 0; //Let it 0 if dont want to change
+
+//Model fitted by doFit, a key of fit_models (src/dofits/fit_models.h). It can be changed between fits, even bin by bin
+string fit_model = "GaussCB";
+
+//Information for output at the end of run
+string prefix_file_name = "";
+
+#include "../fit_yields.h"
+#include "../fit_backend.h"
+#include "../warm_start.h"
+#include "../fit_health.h"
+#include "../fit_snapshot.h"
+#include "../fit_cache.h"
+#include "../memory_monitor.h"
+#include "../toy_efficiency.h"
+using namespace RooFit;
+
+//Status, time and health of the last fit of doFit
+FitInfo last_fit_info = {-1, 0.};
+
+//Returns [yield_all, yield_pass, err_all, err_pass]
+//Signal and Background are the structs of signal_models.h and background_models.h, Data one of datasets.h
+template <class Signal, class Background, class Data = Dataset>
+YieldsNErrs doFitModel(string condition, string MuonId, const char* savePath = NULL)
+{
+	cout << "----- Fitting data on bin -----\n";
+	cout << "Conditions: " << condition << "\n";
+	cout << "-------------------------------\n";
+	TStopwatch watch;
+
+	//Skips the fit if it was already done with same data, model and settings. Toys need the model, so it is fitted again for them
+	string model_name       = fit_model_name<Signal, Background>();
+	string model_definition = fit_model_definition<Signal, Background>();
+	string cache_description = fit_cache_description(data_file_path, condition, MuonId, model_definition, fit_backend_description(model_name));
+	YieldsNErrs output = {0., 0., 0., 0.};
+	bool make_toys = (toys_per_bin > 0 && toys_on_this_fit);
+	if (!make_toys && fit_cache_load(cache_description, output, savePath, condition))
+	{
+		//A cached fit with problems is fitted again, so a new run only spends time on the bins that failed
+		last_fit_info = fit_health_info(last_fit_result, watch.RealTime());
+		if (!refit_failing_bins || last_fit_info.problems == "")
+		{
+			last_fit_info.status = -1;
+			return output;
+		}
+		cout << "Cached fit has problems (" << last_fit_info.problems << "). Fitting it again\n";
+	}
+
+	RooRealVar InvariantMass("InvariantMass", "InvariantMass", _mmin, _mmax);
+
+	if (fit_bins > 0) InvariantMass.setBins(fit_bins);
+	fit_bins = InvariantMass.getBinning().numBins();
+
+	//Selects the probes of the bin with compiled selections (or sums the partials of each file) and fills the mass histograms directly
+	//Everything of the fit lives on this scope, so nothing is left behind when it returns
+	TH1D hist_all ("hist_all",  "hist_all",  fit_bins, _mmin, _mmax);
+	TH1D hist_pass("hist_pass", "hist_pass", fit_bins, _mmin, _mmax);
+	hist_all .SetDirectory(0);
+	hist_pass.SetDirectory(0);
+	fill_bin_histograms(data_file_path, condition, MuonId, &hist_all, &hist_pass);
+
+	RooDataHist dh_ALL    ("data_all",  "data_all",  RooArgList(InvariantMass), &hist_all);
+	RooDataHist dh_PASSING("data_pass", "data_pass", RooArgList(InvariantMass), &hist_pass);
+
+	//SIGNAL AND BACKGROUND FUNCTIONS
+	RooRealVar mean("mean", "mean", Data::mean, Data::mean_min, Data::mean_max);
+	Signal     signal(InvariantMass, mean);
+	Background background(InvariantMass);
+
+	RooRealVar n_signal_total("n_signal_total","n_signal_total",dh_ALL.sumEntries()/2,0.,dh_ALL.sumEntries());
+	RooRealVar n_signal_total_pass("n_signal_total_pass","n_signal_total_pass",dh_PASSING.sumEntries()/2,0.,dh_PASSING.sumEntries());
+
+	RooRealVar n_back("n_back","n_back",dh_ALL.sumEntries()/2,0.,dh_ALL.sumEntries());
+	RooRealVar n_back_pass("n_back_pass","n_back_pass",dh_PASSING.sumEntries()/2,0.,dh_PASSING.sumEntries());
+
+	RooAddPdf model     ("model", "model", RooArgList(signal.pdf, background.pdf),RooArgList(n_signal_total, n_back));
+	RooAddPdf model_pass("model_pass", "model_pass", RooArgList(signal.pdf, background.pdf),RooArgList(n_signal_total_pass, n_back_pass));
+
+	// SIMULTANEOUS FIT
+	RooCategory sample("sample","sample") ;
+	sample.defineType("All") ;
+	sample.defineType("Passing") ;
+
+	RooDataHist combData("combData","combined data",InvariantMass,Index(sample),Import("ALL",dh_ALL),Import("PASSING",dh_PASSING));
+
+	RooSimultaneous simPdf("simPdf","simultaneous pdf",sample) ;
+
+	simPdf.addPdf(model,"ALL");
+	simPdf.addPdf(model_pass,"PASSING");
+
+	//Starting values, for the refits that start over
+	unique_ptr<RooArgSet> params (simPdf.getParameters(combData));
+	unique_ptr<RooArgSet> initial((RooArgSet*)params->snapshot());
+
+	unique_ptr<RooFitResult> fitres(fit_with_warm_start(simPdf, combData, model_name));
+	last_fit_info = fit_health_info(fitres.get(), 0.);
+	if (refit_failing_bins && last_fit_info.problems != "")
+		fitres.reset(refit_failing_bin(simPdf, combData, fitres.release(), initial.get(), last_fit_info));
+	last_fit_info.seconds = watch.RealTime();
+
+	//Bootstrap or toys of this bin, starting from the fit that was just made
+	if (make_toys)
+		last_toy_study = toy_study(simPdf, combData, model_name, condition);
+
+	// OUTPUT ARRAY
+	RooRealVar* yield_all = (RooRealVar*) fitres->floatParsFinal().find("n_signal_total");
+	RooRealVar* yield_pass = (RooRealVar*) fitres->floatParsFinal().find("n_signal_total_pass");
+
+	output[0] = yield_all->getVal();
+	output[1] = yield_pass->getVal();
+
+	output[2] = yield_all->getError();
+	output[3] = yield_pass->getError();
+
+	//Plots are only made here on inline mode. On deferred mode render_fits.cpp draws them from the snapshot
+	RooPlot* frame      = NULL;
+	RooPlot* frame_pass = NULL;
+	if (fit_plot_mode == "inline")
+	{
+		TCanvas* c_all  = new TCanvas;
+		TCanvas* c_pass = new TCanvas;
+		int component_colors[] = {kGreen, kMagenta - 5};
+
+		frame = InvariantMass.frame(RooFit::Title("Invariant Mass"));
+
+		frame->SetTitle("ALL");
+		frame->SetXTitle("#mu^{+}#mu^{-} invariant mass [GeV/c^{2}]");
+		dh_ALL.plotOn(frame);
+
+		model.plotOn(frame);
+		for (size_t i = 0; i < signal.components().size(); i++)
+			model.plotOn(frame,RooFit::Components(signal.components()[i]),RooFit::LineStyle(kDashed),RooFit::LineColor(component_colors[i%2]));
+		model.plotOn(frame,RooFit::Components("background"),RooFit::LineStyle(kDashed),RooFit::LineColor(kRed));
+
+		c_all->cd();
+		frame->Draw("");
+
+		frame_pass = InvariantMass.frame(RooFit::Title("Invariant Mass"));
+
+		c_pass->cd();
+
+		frame_pass->SetTitle("PASSING");
+		frame_pass->SetXTitle("#mu^{+}#mu^{-} invariant mass [GeV/c^{2}]");
+		dh_PASSING.plotOn(frame_pass);
+
+		model_pass.plotOn(frame_pass);
+		for (size_t i = 0; i < signal.components().size(); i++)
+			model_pass.plotOn(frame_pass,RooFit::Components(signal.components()[i]),RooFit::LineStyle(kDashed),RooFit::LineColor(component_colors[i%2]));
+		model_pass.plotOn(frame_pass,RooFit::Components("background"),RooFit::LineStyle(kDashed),RooFit::LineColor(kRed));
+
+		frame_pass->Draw();
+
+		if (savePath != NULL)
+		{
+			c_pass->SaveAs((string(savePath) + condition + "_PASS.png").c_str());
+			c_all->SaveAs ((string(savePath) + condition + "_ALL.png").c_str());
+		}
+
+		delete c_all;
+		delete c_pass;
+	}
+	else if (fit_plot_mode == "deferred" && savePath != NULL)
+		write_fit_record(string(savePath) + condition + ".root", output, fitres.get(), &hist_all, &hist_pass, model_name, condition);
+
+	//A fast fit that fell back to RooFit, or was refitted by it, is stored as a RooFit result
+	string result_backend = fit_result_backend(fitres.get());
+	if (result_backend != fit_backend_description(model_name))
+		cache_description = fit_cache_description(data_file_path, condition, MuonId, model_definition, result_backend);
+	fit_cache_store(cache_description, output, fitres.get(), &hist_all, &hist_pass, model_name, condition, frame, frame_pass);
+
+	cout << "-------------------------------\n";
+
+	delete frame;
+	delete frame_pass;
+
+	monitor_memory();
+	return output;
+}
+
+//Fit function of each model name, filled with every combination of fit_models.h
+typedef YieldsNErrs (*FitFunction)(string condition, string MuonId, const char* savePath);
+map<string, FitFunction> fit_models;
+map<string, string>      fit_model_definitions;
+
+struct FitModelRegistry
+{
+	template <class Signal, class Background>
+	void add()
+	{
+		fit_models           [fit_model_name<Signal, Background>()] = doFitModel<Signal, Background, Dataset>;
+		fit_model_definitions[fit_model_name<Signal, Background>()] = fit_model_definition<Signal, Background>();
+	}
+};
+
+bool register_fit_models()
+{
+	FitModelRegistry registry;
+	for_each_fit_model(registry);
+	return true;
+}
+bool fit_models_registered = register_fit_models();
+
+//Fits with the model chosen by fit_model. Returns [yield_all, yield_pass, err_all, err_pass]
+YieldsNErrs doFit(string condition, string MuonId, const char* savePath = NULL)
+{
+	if (fit_models.find(fit_model) == fit_models.end())
+	{
+		cerr << "Fit model \"" << fit_model << "\" does not exist. The models are listed in src/dofits/fit_models.h\n";
+		abort();
+	}
+	return fit_models[fit_model](condition, MuonId, savePath);
+}
+#endif
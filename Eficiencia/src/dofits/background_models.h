@@ -0,0 +1,39 @@
+#ifndef BACKGROUND_MODELS_HEADER
+#define BACKGROUND_MODELS_HEADER
+//Background models of the fits. Each one builds its pdf, named "background", on the mass of the fit
+//suffix is added to the name of the signal model to make the key of the fit model, so the Exponential keeps the old names
+#include "RooChebychev.h"
+#include "RooExponential.h"
+#include "RooRealVar.h"
+
+struct Exponential
+{
+	static constexpr const char* suffix     = "";
+	static constexpr const char* definition = "Exponential(a0)";
+
+	RooRealVar     a0;
+	RooExponential pdf;
+
+	Exponential(RooRealVar& InvariantMass) :
+		a0("a0", "a0", 0, -10, 0, ""),
+		pdf("background", "background", InvariantMass, a0)
+	{}
+};
+
+//Second order Chebychev polynomial, for the systematic of the background shape
+struct Chebychev
+{
+	static constexpr const char* suffix     = "_Chebychev";
+	static constexpr const char* definition = "Chebychev(c0, c1)";
+
+	RooRealVar   c0;
+	RooRealVar   c1;
+	RooChebychev pdf;
+
+	Chebychev(RooRealVar& InvariantMass) :
+		c0("c0", "c0", 0., -1., 1.),
+		c1("c1", "c1", 0., -1., 1.),
+		pdf("background", "background", InvariantMass, RooArgList(c0, c1))
+	{}
+};
+#endif
@@ -0,0 +1,31 @@
+#ifndef DATASETS_HEADER
+#define DATASETS_HEADER
+//Datasets that can be fitted. The DoFit_*.h header included by the macro chooses one
+//Its files, tag selection and fit range are only the starting values of the settings in DoFit.h, which can be changed at runtime
+
+//Real data of 2011
+struct Jpsi_Run_2011
+{
+	static constexpr const char* output_folder_name = "Jpsi_Run_2011";
+
+	//Input files (one path, glob pattern, comma separated paths or .txt list) and selection of the tag muon
+	static constexpr const char* data_file_path = "DATA/TagAndProbe_Jpsi_Run2011.root";
+	static constexpr const char* tag_cut = "TagMuon_Pt >= 7.0 && fabs(TagMuon_Eta) <= 2.4";
+
+	//Fit range
+	static constexpr double mmin = 2.8;
+	static constexpr double mmax = 3.3;
+
+	//Start and limits of the mean of the signal
+	static constexpr double mean     = 3.094;
+	static constexpr double mean_min = 3.07;
+	static constexpr double mean_max = 3.2;
+};
+
+//Simulated data, same resonance and selection
+struct Jpsi_MC_2020 : Jpsi_Run_2011
+{
+	static constexpr const char* output_folder_name = "Jpsi_MC_2020";
+	static constexpr const char* data_file_path     = "DATA/TagAndProbe_Jpsi_Run2011_MC.root";
+};
+#endif
@@ -0,0 +1,34 @@
+#ifndef FIT_MODELS_HEADER
+#define FIT_MODELS_HEADER
+//Combinations of signal and background that can be chosen by name at runtime
+//Add a line to for_each_fit_model to make a new combination available to doFit, the variations and render_fits.cpp
+#include "signal_models.h"
+#include "background_models.h"
+
+//Key of a combination, like "GaussCB" or "GaussCB_Chebychev"
+template <class Signal, class Background>
+string fit_model_name()
+{
+	return string(Signal::name) + Background::suffix;
+}
+
+template <class Signal, class Background>
+string fit_model_definition()
+{
+	return string(Signal::definition) + " + " + Background::definition;
+}
+
+//Calls registry.template add<Signal, Background>() for every combination
+template <class Registry>
+void for_each_fit_model(Registry& registry)
+{
+	registry.template add<GaussCB,  Exponential>();
+	registry.template add<TwoGauss, Exponential>();
+	registry.template add<GaussCB,  Chebychev>();
+	registry.template add<TwoGauss, Chebychev>();
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,24,0)
+	registry.template add<DSCB,     Exponential>();
+	registry.template add<DSCB,     Chebychev>();
+#endif
+}
+#endif
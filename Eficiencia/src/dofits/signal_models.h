@@ -0,0 +1,97 @@
+#ifndef SIGNAL_MODELS_HEADER
+#define SIGNAL_MODELS_HEADER
+//Signal models of the fits. Each one builds its pdf, named "signal", around the mass and the mean of the fit
+//name is its key in fit_models and in the snapshots. definition goes to the fit cache, so change it if the model changes
+//components are drawn with dashed lines on the plots
+#include "RVersion.h"
+#include "RooAddPdf.h"
+#include "RooCBShape.h"
+#include "RooGaussian.h"
+#include "RooRealVar.h"
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,24,0)
+#include "RooCrystalBall.h"
+#endif
+
+//Gaussian + CrystalBall with the same mean
+struct GaussCB
+{
+	static constexpr const char* name       = "GaussCB";
+	static constexpr const char* definition = "Gaussian(mean, sigma_gs) + CrystalBall(mean, sigma_cb = 0.038, alpha = 1.71, n = 3.96), frac1 = 0.55";
+
+	RooRealVar  sigma_gs;
+	RooRealVar  sigma_cb;
+	RooRealVar  alpha;
+	RooRealVar  n;
+	RooRealVar  frac1;
+	RooGaussian gaussian;
+	RooCBShape  crystalball;
+	RooAddPdf   pdf;
+
+	GaussCB(RooRealVar& InvariantMass, RooRealVar& mean) :
+		sigma_gs("sigma_gs", "sigma_gs", 0.05*(InvariantMass.getMax()-InvariantMass.getMin()), 0., 0.5*(InvariantMass.getMax()-InvariantMass.getMin())),
+		sigma_cb("sigma_cb", "sigma_cb", 0.038),
+		alpha("alpha", "alpha", 1.71),
+		n("n", "n", 3.96),
+		frac1("frac1", "frac1", 0.55),
+		gaussian("GS", "GS", InvariantMass, mean, sigma_gs),
+		crystalball("CB", "CB", InvariantMass, mean, sigma_cb, alpha, n),
+		pdf("signal", "signal", RooArgList(gaussian, crystalball), RooArgList(frac1))
+	{
+		n.setConstant(kTRUE);
+	}
+
+	vector<const char*> components() { return {"GS", "CB"}; }
+};
+
+//Two Gaussians with the same mean
+struct TwoGauss
+{
+	static constexpr const char* name       = "2xGauss";
+	static constexpr const char* definition = "Gaussian(mean, sigma1) + Gaussian(mean, sigma2 = 0.038), frac1 = 0.5";
+
+	RooRealVar  sigma1;
+	RooRealVar  sigma2;
+	RooRealVar  frac1;
+	RooGaussian gaussian1;
+	RooGaussian gaussian2;
+	RooAddPdf   pdf;
+
+	TwoGauss(RooRealVar& InvariantMass, RooRealVar& mean) :
+		sigma1("sigma1", "sigma1", 0.05*(InvariantMass.getMax()-InvariantMass.getMin()), 0., 0.5*(InvariantMass.getMax()-InvariantMass.getMin())),
+		sigma2("sigma2", "sigma2", 0.038),
+		frac1("frac1", "frac1", 0.5),
+		gaussian1("GS1", "GS1", InvariantMass, mean, sigma1),
+		gaussian2("GS2", "GS2", InvariantMass, mean, sigma2),
+		pdf("signal", "signal", RooArgList(gaussian1, gaussian2), RooArgList(frac1))
+	{}
+
+	vector<const char*> components() { return {"GS1", "GS2"}; }
+};
+
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,24,0)
+//Double sided CrystalBall (RooCrystalBall exists since ROOT 6.24). Tails fixed as the CrystalBall of GaussCB
+struct DSCB
+{
+	static constexpr const char* name       = "DSCB";
+	static constexpr const char* definition = "DoubleSidedCrystalBall(mean, sigma_dscb, alpha_l = 1.71, n_l = 3.96, alpha_r = 2.0, n_r = 3.0)";
+
+	RooRealVar     sigma_dscb;
+	RooRealVar     alpha_l;
+	RooRealVar     n_l;
+	RooRealVar     alpha_r;
+	RooRealVar     n_r;
+	RooCrystalBall pdf;
+
+	DSCB(RooRealVar& InvariantMass, RooRealVar& mean) :
+		sigma_dscb("sigma_dscb", "sigma_dscb", 0.05*(InvariantMass.getMax()-InvariantMass.getMin()), 0., 0.5*(InvariantMass.getMax()-InvariantMass.getMin())),
+		alpha_l("alpha_l", "alpha_l", 1.71),
+		n_l("n_l", "n_l", 3.96),
+		alpha_r("alpha_r", "alpha_r", 2.0),
+		n_r("n_r", "n_r", 3.0),
+		pdf("signal", "signal", InvariantMass, mean, sigma_dscb, alpha_l, n_l, alpha_r, n_r)
+	{}
+
+	vector<const char*> components() { return {}; }
+};
+#endif
+#endif
@@ -0,0 +1,115 @@
+#ifndef EFFICIENCY_LOOKUP_HEADER
+#define EFFICIENCY_LOOKUP_HEADER
+//Efficiency of an event from the N-dimensional efficiency written by efficiency_nd.cpp, for weighting events downstream
+//Only populated cells are kept, in a hash table by cell index, so memory follows the cells that were fitted
+//It does not need the fitting headers: include it after src/root_headers.h
+//Axis of the THnSparse: name is the quantity, a title starting with "abs(" means its absolute value is binned
+#include <unordered_map>
+#include "THnSparse.h"
+
+struct EfficiencyLookup
+{
+	vector<vector<double>> edges;     //Of each axis
+	vector<bool>           absolute;  //Axis bins the absolute value
+	vector<long long>      strides;   //Cell index is the sum of bin*stride of every axis
+	unordered_map<long long, pair<float, float>> cells;  //Efficiency and error of every populated cell
+};
+
+//Bin of value on edges, -1 if it is outside. Bin i is [edges[i], edges[i+1]), as the conditions of the efficiency macros
+inline int lookup_axis_bin(const vector<double>& edges, double value)
+{
+	if (!(value >= edges.front() && value < edges.back()))
+		return -1;
+	return upper_bound(edges.begin(), edges.end(), value) - edges.begin() - 1;
+}
+
+//Cell of the values (one by axis, in the order of the axes), -1 if it is outside of the binning
+inline long long lookup_cell(const EfficiencyLookup& lookup, const double* values)
+{
+	long long cell = 0;
+	for (size_t d = 0; d < lookup.edges.size(); d++)
+	{
+		int bin = lookup_axis_bin(lookup.edges[d], lookup.absolute[d] ? fabs(values[d]) : values[d]);
+		if (bin < 0)
+			return -1;
+		cell += bin*lookup.strides[d];
+	}
+	return cell;
+}
+
+//Efficiency and error of the cell of the values. Returns false, leaving them as they are, for cells outside of the binning
+//or not fitted, so the caller decides what those events get
+inline bool lookup_efficiency(const EfficiencyLookup& lookup, const double* values, double& efficiency, double& error)
+{
+	auto found = lookup.cells.find(lookup_cell(lookup, values));
+	if (found == lookup.cells.end())
+		return false;
+
+	efficiency = found->second.first;
+	error      = found->second.second;
+	return true;
+}
+
+//Lookup of the filled bins of an efficiency THnSparse
+EfficiencyLookup make_efficiency_lookup(THnSparse* heff)
+{
+	EfficiencyLookup lookup;
+	int ndims = heff->GetNdimensions();
+	long long stride = 1;
+	for (int d = 0; d < ndims; d++)
+	{
+		TAxis* axis = heff->GetAxis(d);
+		vector<double> edges(axis->GetNbins() + 1);
+		for (int i = 0; i <= axis->GetNbins(); i++)
+			edges[i] = axis->GetBinLowEdge(i+1);
+
+		lookup.edges   .push_back(edges);
+		lookup.absolute.push_back(string(axis->GetTitle()).substr(0, 4) == "abs(");
+		lookup.strides .push_back(stride);
+		stride *= axis->GetNbins();
+	}
+
+	vector<int> coords(ndims);
+	lookup.cells.reserve(heff->GetNbins());
+	for (Long64_t i = 0; i < heff->GetNbins(); i++)
+	{
+		double efficiency = heff->GetBinContent(i, coords.data());
+		long long cell = 0;
+		bool inside = true;
+		for (int d = 0; d < ndims; d++)
+		{
+			inside = inside && coords[d] >= 1 && coords[d] <= heff->GetAxis(d)->GetNbins();
+			cell  += (coords[d] - 1)*lookup.strides[d];
+		}
+		if (inside)
+			lookup.cells[cell] = make_pair((float)efficiency, (float)heff->GetBinError(i));
+	}
+	return lookup;
+}
+
+//Reads the efficiency THnSparse called name from a file of efficiency_nd.cpp
+EfficiencyLookup read_efficiency_lookup(string path, string name)
+{
+	TDirectory* previous_dir = gDirectory;
+	TFile* file = TFile::Open(path.c_str());
+	previous_dir->cd();
+	if (file == NULL || file->IsZombie())
+	{
+		cerr << "Could not open \"" << path << "\" efficiency file\n";
+		abort();
+	}
+
+	THnSparse* heff = (THnSparse*)file->Get(name.c_str());
+	if (heff == NULL)
+	{
+		cerr << "Could not find \"" << name << "\" in \"" << path << "\"\n";
+		abort();
+	}
+
+	EfficiencyLookup lookup = make_efficiency_lookup(heff);
+	delete heff;
+	file->Close();
+	delete file;
+	return lookup;
+}
+#endif
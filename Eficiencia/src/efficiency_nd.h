@@ -0,0 +1,144 @@
+#ifndef EFFICIENCY_ND_HEADER
+#define EFFICIENCY_ND_HEADER
+//Efficiency on N quantities at once (pT x |eta| x phi, for example), where most cells of the grid can be empty
+//Probes are counted on every cell in a single pass, and only cells with enough probes are fitted
+//Cells are kept by their index in maps and the results in THnSparse, so memory and fits follow the populated cells, not the whole grid
+//Include it after the DoFit headers
+#include "THnSparse.h"
+#include "cut_and_count.h"
+#include "efficiency_lookup.h"
+
+struct NDAxis
+{
+	string         quantity;  //"Pt", "Eta" or "Phi"
+	vector<double> edges;
+	bool           absolute;  //Bins the absolute value, as the y axis of plot_sys_efficiency_2d.cpp
+};
+
+//Cell index is the sum of bin*stride of every axis, the first axis changing fastest
+vector<long long> nd_strides(const vector<NDAxis>& axes)
+{
+	vector<long long> strides;
+	long long stride = 1;
+	for (const NDAxis& axis : axes)
+	{
+		strides.push_back(stride);
+		stride *= axis.edges.size() - 1;
+	}
+	return strides;
+}
+
+long long nd_total_cells(const vector<NDAxis>& axes)
+{
+	long long total = 1;
+	for (const NDAxis& axis : axes)
+		total *= axis.edges.size() - 1;
+	return total;
+}
+
+//Bin of every axis of a cell
+vector<int> nd_cell_bins(const vector<NDAxis>& axes, long long cell)
+{
+	vector<int> bins;
+	for (const NDAxis& axis : axes)
+	{
+		int nbins = axis.edges.size() - 1;
+		bins.push_back(cell % nbins);
+		cell /= nbins;
+	}
+	return bins;
+}
+
+//Probes of ALL on every cell that has any, in the fit range, in a single pass over the probes that pass the tag selection
+map<long long, long long> count_nd_cells(const char* data_path, const vector<NDAxis>& axes)
+{
+	const ProbeDataset&     dataset  = load_probe_dataset(data_path);
+	const DatasetSelection& selected = select_bin_probes(data_path, "1");
+	vector<long long>       strides  = nd_strides(axes);
+
+	//Edges in float, as the conditions of the fits (see float_literals)
+	vector<vector<double>> edges;
+	for (const NDAxis& axis : axes)
+		edges.push_back(float_edges(axis.edges));
+
+	//Each file counts on its own thread, only on the cells it finds
+	vector<unordered_map<long long, long long>> file_counts(dataset.size());
+	for_each_file(dataset.size(), [&](unsigned f)
+	{
+		const ProbeColumns& columns = *dataset[f];
+		vector<const float*> values;
+		for (const NDAxis& axis : axes)
+			values.push_back(quantity_column(columns, axis.quantity));
+
+		for (unsigned i : selected[f])
+		{
+			if (columns.InvariantMass[i] < _mmin || columns.InvariantMass[i] >= _mmax)
+				continue;
+
+			long long cell = 0;
+			for (size_t d = 0; d < axes.size() && cell >= 0; d++)
+			{
+				int bin = lookup_axis_bin(edges[d], axes[d].absolute ? fabs(values[d][i]) : values[d][i]);
+				cell = (bin < 0) ? -1 : cell + bin*strides[d];
+			}
+			if (cell >= 0)
+				file_counts[f][cell]++;
+		}
+	});
+
+	map<long long, long long> counts;
+	for (auto& partial : file_counts)
+		for (auto& cell : partial)
+			counts[cell.first] += cell.second;
+	return counts;
+}
+
+//Condition of a cell, written as the conditions of the other macros
+string nd_cell_condition(const vector<NDAxis>& axes, long long cell)
+{
+	vector<int> bins = nd_cell_bins(axes, cell);
+	string condition;
+	for (size_t d = 0; d < axes.size(); d++)
+	{
+		string value = axes[d].absolute ? "abs(ProbeMuon_" + axes[d].quantity + ")" : "ProbeMuon_" + axes[d].quantity;
+		condition += (d > 0 ? " && " : "") + value + ">=" + to_string(axes[d].edges[bins[d]]);
+		condition += " && " + value + "< " + to_string(axes[d].edges[bins[d]+1]);
+	}
+	return condition;
+}
+
+//Empty THnSparse with the binning of the axes. Absolute axes have a title starting with "abs(" (see efficiency_lookup.h)
+THnSparseD* create_nd_histogram(string name, string title, const vector<NDAxis>& axes)
+{
+	int ndims = axes.size();
+	vector<int>    nbins;
+	vector<double> xmin, xmax;
+	for (const NDAxis& axis : axes)
+	{
+		nbins.push_back(axis.edges.size() - 1);
+		xmin .push_back(axis.edges.front());
+		xmax .push_back(axis.edges.back());
+	}
+
+	THnSparseD* hist = new THnSparseD(name.c_str(), title.c_str(), ndims, nbins.data(), xmin.data(), xmax.data());
+	for (int d = 0; d < ndims; d++)
+	{
+		hist->GetAxis(d)->Set(nbins[d], axes[d].edges.data());
+		hist->GetAxis(d)->SetName(axes[d].quantity.c_str());
+		hist->GetAxis(d)->SetTitle((axes[d].absolute ? "abs(" + axes[d].quantity + ")" : axes[d].quantity).c_str());
+	}
+	hist->Sumw2();
+	return hist;
+}
+
+void set_nd_bin(THnSparseD* hist, const vector<NDAxis>& axes, long long cell, double value, double error)
+{
+	vector<int> coords = nd_cell_bins(axes, cell);
+	for (int& coord : coords)
+		coord++;
+
+	Long64_t bin = hist->GetBin(coords.data());
+	hist->SetBinContent(bin, value);
+	hist->SetBinError  (bin, error);
+}
+#endif
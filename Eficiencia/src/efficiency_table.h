@@ -0,0 +1,155 @@
+#ifndef EFFICIENCY_TABLE_HEADER
+#define EFFICIENCY_TABLE_HEADER
+//Efficiency of each muon, and of the dimuon, from a table written by export_efficiency_table.cpp, for weighting candidates in an event loop
+//It only needs the standard library, so analyses outside of this folder can include it without ROOT
+//Cells are flat arrays and the bin search has no data dependent branches, so a lookup takes a few nanoseconds
+//Table file: lines "x <quantity> <edges>" and "y <quantity> <edges>" ("abs(Eta)" bins |Eta|, y is optional),
+//then one line per cell "<efficiency> <stat> <syst>" with x changing fastest. Lines starting with # are comments
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//Bin of value on nbins+1 edges. The loop length only depends on nbins and the comparison becomes a conditional move
+//Values out of the edges take the first or the last bin, as NaN takes the first one. EfficiencyTable::in_range tells them apart
+inline int efficiency_table_bin(const double* edges, int nbins, double value)
+{
+	const double* base = edges;
+	int n = nbins;
+	while (n > 1)
+	{
+		int half = n/2;
+		base = (base[half] <= value) ? base + half : base;
+		n -= half;
+	}
+	return base - edges;
+}
+
+struct EfficiencyTable
+{
+	std::string         xquantity, yquantity;
+	bool                xabsolute, yabsolute;
+	std::vector<double> xedges, yedges;
+	int                 nx, ny;
+
+	//By cell, x changing fastest
+	std::vector<float> efficiency;
+	std::vector<float> stat;
+	std::vector<float> syst;
+
+	EfficiencyTable(std::string path)
+	{
+		std::ifstream file(path);
+		if (!file)
+		{
+			std::cerr << "Could not open \"" << path << "\" efficiency table\n";
+			abort();
+		}
+
+		//Without y line there is a single y bin
+		xabsolute = yabsolute = false;
+		yedges = {-HUGE_VAL, HUGE_VAL};
+
+		std::string line;
+		while (std::getline(file, line))
+		{
+			std::stringstream fields(line);
+			std::string name;
+			if (!(fields >> name) || name[0] == '#')
+				continue;
+
+			if (name == "x" || name == "y")
+			{
+				std::string quantity;
+				std::vector<double> edges;
+				double edge;
+				fields >> quantity;
+				while (fields >> edge)
+					edges.push_back(edge);
+
+				bool absolute = quantity.substr(0, 4) == "abs(";
+				if (absolute)
+					quantity = quantity.substr(4, quantity.size() - 5);
+				if (name == "x") { xquantity = quantity; xabsolute = absolute; xedges = edges; }
+				else             { yquantity = quantity; yabsolute = absolute; yedges = edges; }
+				continue;
+			}
+
+			std::stringstream cell(line);
+			float value, stat_error, syst_error;
+			if (!(cell >> value >> stat_error >> syst_error))
+			{
+				std::cerr << "Could not read the line \"" << line << "\" of \"" << path << "\"\n";
+				abort();
+			}
+			efficiency.push_back(value);
+			stat      .push_back(stat_error);
+			syst      .push_back(syst_error);
+		}
+
+		nx = xedges.size() - 1;
+		ny = yedges.size() - 1;
+		if (nx < 1 || ny < 1 || (int)efficiency.size() != nx*ny)
+		{
+			std::cerr << "\"" << path << "\" has " << efficiency.size() << " cells, but its edges need " << nx*ny << "\n";
+			abort();
+		}
+	}
+
+	//Whether x and y are inside of the edges. Outside, cell and the efficiencies use the nearest bin of the edge
+	bool in_range(double x, double y) const
+	{
+		double xvalue = xabsolute ? std::fabs(x) : x;
+		double yvalue = yabsolute ? std::fabs(y) : y;
+		return xvalue >= xedges.front() && xvalue < xedges.back() && yvalue >= yedges.front() && yvalue < yedges.back();
+	}
+
+	int cell(double x, double y) const
+	{
+		int i = efficiency_table_bin(xedges.data(), nx, xabsolute ? std::fabs(x) : x);
+		int j = efficiency_table_bin(yedges.data(), ny, yabsolute ? std::fabs(y) : y);
+		return j*nx + i;
+	}
+
+	//Efficiency of a muon, x and y in the quantities of the table (pT and eta, for example)
+	float operator()(double x, double y) const
+	{
+		return efficiency[cell(x, y)];
+	}
+
+	//Efficiency of the dimuon, as the product of both muons
+	float dimuon(double x1, double y1, double x2, double y2) const
+	{
+		return efficiency[cell(x1, y1)]*efficiency[cell(x2, y2)];
+	}
+
+	//Errors of the dimuon efficiency. Statistic errors of both muons are independent (added in quadrature)
+	//and systematic ones come from the same fits, so they are fully correlated (added linearly)
+	void dimuon_errors(double x1, double y1, double x2, double y2, float& stat_error, float& syst_error) const
+	{
+		int   cell1   = cell(x1, y1);
+		int   cell2   = cell(x2, y2);
+		float product = efficiency[cell1]*efficiency[cell2];
+		stat_error = product*std::sqrt(std::pow(stat[cell1]/efficiency[cell1], 2) + std::pow(stat[cell2]/efficiency[cell2], 2));
+		syst_error = product*(syst[cell1]/efficiency[cell1] + syst[cell2]/efficiency[cell2]);
+	}
+
+	//Efficiency of n muons. Each one is independent and has no branches, so the compiler can vectorize the loop
+	//(with gathers when built with -march=native, as EFFICIENCY_NATIVE of CMakeLists.txt)
+	void efficiency_batch(const double* x, const double* y, float* output, int n) const
+	{
+		const double* xedges_data     = xedges.data();
+		const double* yedges_data     = yedges.data();
+		const float*  efficiency_data = efficiency.data();
+		for (int k = 0; k < n; k++)
+		{
+			int i = efficiency_table_bin(xedges_data, nx, xabsolute ? std::fabs(x[k]) : x[k]);
+			int j = efficiency_table_bin(yedges_data, ny, yabsolute ? std::fabs(y[k]) : y[k]);
+			output[k] = efficiency_data[j*nx + i];
+		}
+	}
+};
+#endif
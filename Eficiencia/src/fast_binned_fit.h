@@ -0,0 +1,318 @@
+#ifndef FAST_BINNED_FIT_HEADER
+#define FAST_BINNED_FIT_HEADER
+//Fast extended binned likelihood for the doFit models, minimized directly with Minuit2
+//Signal: frac1*Gaussian(mean, sigma) + (1-frac1)*[CrystalBall(mean, sigma2, alpha, n) or Gaussian(mean, sigma2)]
+//Background: Exponential(a0)
+//ALL and PASSING share the shape parameters and have their own yields, as the RooSimultaneous in doFit
+//
+//The pdfs are integrated analytically on every bin. The cumulative function is evaluated once per bin edge,
+//then every loop runs over contiguous arrays without branches, so the compiler can vectorize it
+//(load it compiled with ACLiC, ".L src/fast_binned_fit.h+", to get the full speed)
+#include "Minuit2/FCNGradientBase.h"
+#include "Minuit2/FunctionMinimum.h"
+#include "Minuit2/MnHesse.h"
+#include "Minuit2/MnMigrad.h"
+#include "Minuit2/MnStrategy.h"
+#include "Minuit2/MnUserParameters.h"
+#include "Minuit2/MnUserParameterState.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+//Order of the parameters on every array used here
+enum FastFitParameter {kMean, kSigma, kA0, kNSignal, kNSignalPass, kNBack, kNBackPass, kNFastFitParameters};
+const char* fast_fit_parameter_names[kNFastFitParameters] = {"mean", "sigma", "a0", "n_signal_total", "n_signal_total_pass", "n_back", "n_back_pass"};
+
+struct FastFitResult
+{
+	std::vector<double> values;
+	std::vector<double> errors;
+	int    status;  //Same meaning as Minuit: 0 means converged
+	double cov_signal;  //Covariance of n_signal_total and n_signal_total_pass
+	double min_nll;
+	double edm;
+	int    ncalls;
+};
+
+struct FastBinnedNLL
+{
+	//Signal model: "GaussCB" or "2xGauss"
+	std::string model;
+
+	//Fixed parameters of the signal (alpha and n are only used by the CrystalBall)
+	double sigma2;
+	double alpha;
+	double n;
+	double frac1;
+
+	//Bin edges of the mass (shifted to start at 0) and counts of each category
+	int nbins;
+	std::vector<double> edges;
+	std::vector<double> counts_all;
+	std::vector<double> counts_pass;
+
+	//Work buffers, allocated once and reused by every evaluation
+	mutable std::vector<double> t, cdf, pdf;
+	mutable std::vector<double> sig, dsig_dmean, dsig_dsigma;
+	mutable std::vector<double> shape, dshape_dmean, dshape_dsigma;
+	mutable std::vector<double> bkg, dbkg_da0;
+	mutable int ncalls;
+
+	FastBinnedNLL(std::string model_name, double mmin, double mmax, int number_of_bins,
+		double sigma2_value, double alpha_value = 1.71, double n_value = 3.96, double frac1_value = 0.55)
+	{
+		model  = model_name;
+		sigma2 = sigma2_value;
+		alpha  = fabs(alpha_value);
+		n      = n_value;
+		frac1  = frac1_value;
+		nbins  = number_of_bins;
+		ncalls = 0;
+
+		edges.resize(nbins+1);
+		for (int i = 0; i <= nbins; i++)
+			edges[i] = (mmax - mmin)*i/nbins;
+		mass_offset = mmin;
+
+		counts_all .assign(nbins, 0.);
+		counts_pass.assign(nbins, 0.);
+
+		t  .resize(nbins+1);
+		cdf.resize(nbins+1);
+		pdf.resize(nbins+1);
+		sig          .resize(nbins);
+		dsig_dmean   .resize(nbins);
+		dsig_dsigma  .resize(nbins);
+		shape        .resize(nbins);
+		dshape_dmean .resize(nbins);
+		dshape_dsigma.resize(nbins);
+		bkg          .resize(nbins);
+		dbkg_da0     .resize(nbins);
+	}
+
+	//Lower edge of the mass range, the edges are stored relative to it
+	double mass_offset;
+
+	void set_data(const double* all, const double* pass)
+	{
+		counts_all .assign(all,  all  + nbins);
+		counts_pass.assign(pass, pass + nbins);
+	}
+
+	//Gaussian: cumulative and density in the standardized variable
+	static double gauss_cdf(double x) { return 1.2533141373155003*erf(x*0.7071067811865476); }
+	static double gauss_pdf(double x) { return exp(-0.5*x*x); }
+
+	//CrystalBall (RooCBShape, tail on the low mass side): cumulative and density in the standardized variable
+	double cb_cdf(double x) const
+	{
+		double A = pow(n/alpha, n)*exp(-0.5*alpha*alpha);
+		double B = n/alpha - alpha;
+		double tail_cdf = A*pow(B - x, 1. - n)/(n - 1.);
+		double core_cdf = A*pow(B + alpha, 1. - n)/(n - 1.) + gauss_cdf(x) - gauss_cdf(-alpha);
+		return (x <= -alpha) ? tail_cdf : core_cdf;
+	}
+	double cb_pdf(double x) const
+	{
+		double A = pow(n/alpha, n)*exp(-0.5*alpha*alpha);
+		double B = n/alpha - alpha;
+		return (x <= -alpha) ? A*pow(B - x, -n) : gauss_pdf(x);
+	}
+
+	//Fraction of a normalized shape on every bin and its derivatives with mean and width
+	void shape_fractions(bool crystal_ball, double mean, double sigma) const
+	{
+		for (int i = 0; i <= nbins; i++)
+			t[i] = (edges[i] + mass_offset - mean)/sigma;
+
+		if (crystal_ball)
+			for (int i = 0; i <= nbins; i++)
+			{
+				cdf[i] = cb_cdf(t[i]);
+				pdf[i] = cb_pdf(t[i]);
+			}
+		else
+			for (int i = 0; i <= nbins; i++)
+			{
+				cdf[i] = gauss_cdf(t[i]);
+				pdf[i] = gauss_pdf(t[i]);
+			}
+
+		//d cdf/d mean = -pdf/sigma and d cdf/d sigma = -pdf*t/sigma
+		double norm        = cdf[nbins] - cdf[0];
+		double dnorm_dmean = -(pdf[nbins] - pdf[0])/sigma;
+		double dnorm_dsig  = -(pdf[nbins]*t[nbins] - pdf[0]*t[0])/sigma;
+		for (int i = 0; i < nbins; i++)
+		{
+			double delta        = cdf[i+1] - cdf[i];
+			double ddelta_dmean = -(pdf[i+1] - pdf[i])/sigma;
+			double ddelta_dsig  = -(pdf[i+1]*t[i+1] - pdf[i]*t[i])/sigma;
+			shape[i]         = delta/norm;
+			dshape_dmean[i]  = (ddelta_dmean*norm - delta*dnorm_dmean)/(norm*norm);
+			dshape_dsigma[i] = (ddelta_dsig *norm - delta*dnorm_dsig )/(norm*norm);
+		}
+	}
+
+	//Exponential: integral of exp(a0*u) from 0 to u and its derivative with a0
+	static double exp_cdf(double a0, double u)
+	{
+		double x = a0*u;
+		return (fabs(x) < 1e-8) ? u*(1. + 0.5*x) : expm1(x)/a0;
+	}
+	static double exp_dcdf_da0(double a0, double u)
+	{
+		double x = a0*u;
+		return (fabs(x) < 1e-4) ? u*u*(0.5 + x/3. + x*x/8.) : (x*exp(x) - expm1(x))/(a0*a0);
+	}
+
+	void background_fractions(double a0) const
+	{
+		for (int i = 0; i <= nbins; i++)
+		{
+			cdf[i] = exp_cdf     (a0, edges[i]);
+			pdf[i] = exp_dcdf_da0(a0, edges[i]);
+		}
+
+		double norm     = cdf[nbins];
+		double dnorm    = pdf[nbins];
+		for (int i = 0; i < nbins; i++)
+		{
+			double delta  = cdf[i+1] - cdf[i];
+			double ddelta = pdf[i+1] - pdf[i];
+			bkg[i]      = delta/norm;
+			dbkg_da0[i] = (ddelta*norm - delta*dnorm)/(norm*norm);
+		}
+	}
+
+	//Adds -log(L) of one category and its gradient
+	double category_nll(const std::vector<double>& counts, double n_signal, double n_back,
+		double* grad, int n_signal_index, int n_back_index) const
+	{
+		double nll = 0.;
+		double dmean = 0., dsigma = 0., da0 = 0., dn_signal = 0., dn_back = 0.;
+		for (int i = 0; i < nbins; i++)
+		{
+			double expected = n_signal*sig[i] + n_back*bkg[i];
+			expected = (expected > 1e-300) ? expected : 1e-300;
+			nll += expected - counts[i]*log(expected);
+
+			double w = 1. - counts[i]/expected;
+			dn_signal += w*sig[i];
+			dn_back   += w*bkg[i];
+			dmean     += w*n_signal*dsig_dmean[i];
+			dsigma    += w*n_signal*dsig_dsigma[i];
+			da0       += w*n_back*dbkg_da0[i];
+		}
+
+		if (grad != NULL)
+		{
+			grad[kMean]          += dmean;
+			grad[kSigma]         += dsigma;
+			grad[kA0]            += da0;
+			grad[n_signal_index] += dn_signal;
+			grad[n_back_index]   += dn_back;
+		}
+
+		return nll;
+	}
+
+	//-log(L) of the simultaneous fit. Fills the gradient if grad is not NULL
+	double operator()(const double* par, double* grad = NULL) const
+	{
+		ncalls++;
+
+		//Signal = frac1*Gaussian(mean, sigma) + (1-frac1)*second component(mean, sigma2)
+		shape_fractions(false, par[kMean], par[kSigma]);
+		for (int i = 0; i < nbins; i++)
+		{
+			sig[i]         = frac1*shape[i];
+			dsig_dmean[i]  = frac1*dshape_dmean[i];
+			dsig_dsigma[i] = frac1*dshape_dsigma[i];
+		}
+
+		shape_fractions(model == "GaussCB", par[kMean], sigma2);
+		for (int i = 0; i < nbins; i++)
+		{
+			sig[i]        += (1. - frac1)*shape[i];
+			dsig_dmean[i] += (1. - frac1)*dshape_dmean[i];
+		}
+
+		background_fractions(par[kA0]);
+
+		if (grad != NULL)
+			for (int i = 0; i < kNFastFitParameters; i++)
+				grad[i] = 0.;
+
+		double nll = 0.;
+		nll += category_nll(counts_all,  par[kNSignal],     par[kNBack],     grad, kNSignal,     kNBack);
+		nll += category_nll(counts_pass, par[kNSignalPass], par[kNBackPass], grad, kNSignalPass, kNBackPass);
+		return nll;
+	}
+};
+
+//Minuit2 interface with analytic gradient
+struct FastBinnedFCN : public ROOT::Minuit2::FCNGradientBase
+{
+	const FastBinnedNLL& nll;
+	FastBinnedFCN(const FastBinnedNLL& nll_function) : nll(nll_function) {}
+
+	double operator()(const std::vector<double>& par) const override
+	{
+		return nll(par.data());
+	}
+
+	std::vector<double> Gradient(const std::vector<double>& par) const override
+	{
+		std::vector<double> grad(kNFastFitParameters);
+		nll(par.data(), grad.data());
+		return grad;
+	}
+
+	//0.5 for -log(L)
+	double Up() const override { return 0.5; }
+
+	//The analytic gradient is exact, Minuit does not need to check it numerically
+	bool CheckGradient() const override { return false; }
+};
+
+//Migrad + Hesse, as RooFit does by default
+FastFitResult fast_binned_fit(const FastBinnedNLL& nll, const double* start, const double* step,
+	const double* lower, const double* upper, int strategy = 1)
+{
+	nll.ncalls = 0;
+	FastBinnedFCN fcn(nll);
+
+	ROOT::Minuit2::MnUserParameters upar;
+	for (int i = 0; i < kNFastFitParameters; i++)
+		upar.Add(fast_fit_parameter_names[i], start[i], step[i], lower[i], upper[i]);
+
+	ROOT::Minuit2::MnMigrad migrad(fcn, upar, ROOT::Minuit2::MnStrategy(strategy));
+	ROOT::Minuit2::FunctionMinimum minimum = migrad();
+
+	ROOT::Minuit2::MnUserParameterState state = minimum.UserState();
+	if (minimum.IsValid())
+	{
+		ROOT::Minuit2::MnHesse hesse(strategy);
+		state = hesse(fcn, minimum.UserParameters());
+	}
+
+	FastFitResult result;
+	for (int i = 0; i < kNFastFitParameters; i++)
+	{
+		result.values.push_back(state.Value(i));
+		result.errors.push_back(state.Error(i));
+	}
+
+	if      (minimum.IsValid() && state.IsValid()) result.status = 0;
+	else if (minimum.HasReachedCallLimit())        result.status = 4;
+	else if (minimum.IsAboveMaxEdm())              result.status = 3;
+	else                                           result.status = 5;
+
+	result.cov_signal = state.HasCovariance() ? state.Covariance()(kNSignal, kNSignalPass) : 0.;
+	result.min_nll = minimum.Fval();
+	result.edm     = minimum.Edm();
+	result.ncalls  = nll.ncalls;
+	return result;
+}
+#endif
@@ -0,0 +1,241 @@
+#ifndef FIT_BACKEND_HEADER
+#define FIT_BACKEND_HEADER
+#include "fast_binned_fit.h"
+
+//Which code minimizes the likelihood in doFit:
+//"roofit" uses the RooFit likelihood, configured by the two settings below
+//"fast"   uses fast_binned_fit.h (analytic bin integrals and gradient, Minuit2 directly). Falls back to RooFit if it fails
+//         or if the model was not validated on the dataset (see require_fast_validation)
+string fit_backend = "roofit";
+
+//Fast backend only fits the models that validate_fast_fit.cpp found in agreement with RooFit on the dataset
+//Set it false to use it without validation (validate_fast_fit.cpp and benchmark_fit_backends.cpp do)
+bool require_fast_validation = true;
+
+//Folder of the validation records of validate_fast_fit.cpp
+string fast_validation_folder = "results/validation/";
+
+//Evaluation backend of the RooFit likelihood (ROOT >= 6.30). Empty uses the default of the installed ROOT
+//"legacy", "cpu" (vectorized), "codegen" (generated code with analytic gradient) or "codegen_no_grad"
+string roofit_eval_backend = "";
+
+//Number of processes evaluating the RooFit likelihood in parallel (RooFit::NumCPU). Only the legacy backend supports it
+int roofit_num_cpu = 1;
+
+//Number of likelihood evaluations of the last fit
+int last_fit_nll_calls = 0;
+
+//Short text with the RooFit settings that can change the fit result
+string roofit_backend_description()
+{
+	return string("roofit ") + (roofit_num_cpu > 1 ? "legacy" : roofit_eval_backend);
+}
+
+//Validation record of validate_fast_fit.cpp for the dataset
+string fast_validation_path()
+{
+	return fast_validation_folder + "fast_fit_" + output_folder_name + ".txt";
+}
+
+//The record has a line "validated <model>" for each model that agreed with RooFit on every bin
+bool fast_backend_validated(string model_name)
+{
+	//Read once by record and model
+	static map<string, bool> validated;
+	string key = fast_validation_path() + " " + model_name;
+	if (validated.count(key) == 0)
+	{
+		validated[key] = false;
+		ifstream record(fast_validation_path());
+		string line;
+		while (getline(record, line))
+			if (line == "validated " + model_name)
+				validated[key] = true;
+	}
+	return validated[key];
+}
+
+//fast_binned_fit.h only has the GaussCB and 2xGauss signals with the Exponential background
+bool fast_backend_supports(string model_name)
+{
+	return model_name == "GaussCB" || model_name == "2xGauss";
+}
+
+//Why the fast backend does not fit the model, or "" if it does
+string fast_backend_refusal(string model_name)
+{
+	if (!fast_backend_supports(model_name))
+		return "Fast backend does not have model \"" + model_name + "\"";
+	if (require_fast_validation && !fast_backend_validated(model_name))
+		return "Fast backend is not validated for model \"" + model_name + "\" on " + output_folder_name
+			+ " (run validate_fast_fit.cpp, see " + fast_validation_path() + ")";
+	return "";
+}
+
+//Short text with the settings that can change the fit result of the model, for the backend that run_fit chooses for it
+string fit_backend_description(string model_name)
+{
+	if (fit_backend == "fast" && fast_backend_refusal(model_name) == "")
+		return "fast";
+	return roofit_backend_description();
+}
+
+//Likelihood of fast_binned_fit.h with the binning and fixed parameters of the model and the counts of combData
+//vars gets the RooRealVars of the model in the order of FastFitParameter
+FastBinnedNLL make_fast_nll(RooSimultaneous& simPdf, RooDataHist& combData, string model_name, RooRealVar* vars[kNFastFitParameters])
+{
+	RooArgSet*  params        = simPdf.getParameters(combData);
+	RooArgSet*  observables   = simPdf.getObservables(combData);
+	RooRealVar* InvariantMass = (RooRealVar*)observables->find("InvariantMass");
+
+	//Names of the parameters depend on the signal model
+	bool is_2xGauss = (model_name == "2xGauss");
+	const char* names[kNFastFitParameters] = {"mean", is_2xGauss ? "sigma1" : "sigma_gs", "a0",
+		"n_signal_total", "n_signal_total_pass", "n_back", "n_back_pass"};
+	RooRealVar* sigma2 = (RooRealVar*)params->find(is_2xGauss ? "sigma2" : "sigma_cb");
+	RooRealVar* alpha  = (RooRealVar*)params->find("alpha");
+	RooRealVar* n      = (RooRealVar*)params->find("n");
+	RooRealVar* frac1  = (RooRealVar*)params->find("frac1");
+
+	int nbins = InvariantMass->getBins();
+	FastBinnedNLL nll(model_name, InvariantMass->getMin(), InvariantMass->getMax(), nbins, sigma2->getVal(),
+		is_2xGauss ? 1. : alpha->getVal(), is_2xGauss ? 2. : n->getVal(), frac1->getVal());
+
+	//Counts of each category on every mass bin
+	vector<double> counts_all (nbins, 0.);
+	vector<double> counts_pass(nbins, 0.);
+	for (int i = 0; i < combData.numEntries(); i++)
+	{
+		const RooArgSet* row    = combData.get(i);
+		RooCategory*     sample = (RooCategory*)row->find("sample");
+		RooRealVar*      mass   = (RooRealVar*) row->find("InvariantMass");
+
+		if (string(sample->getCurrentLabel()) == "PASSING")
+			counts_pass[mass->getBin()] += combData.weight();
+		else
+			counts_all [mass->getBin()] += combData.weight();
+	}
+	nll.set_data(counts_all.data(), counts_pass.data());
+
+	for (int i = 0; i < kNFastFitParameters; i++)
+		vars[i] = (RooRealVar*)params->find(names[i]);
+
+	delete observables;
+	delete params;
+	return nll;
+}
+
+//Title of the results of the fast backend. Results are renamed when they are cloned or loaded from the fit cache, titles are kept
+const char* fast_fit_title = "fast_fit_result";
+
+//Same text for the backend that made a result. It differs from fit_backend_description when the fast backend fell back to RooFit
+string fit_result_backend(const RooFitResult* fitres)
+{
+	return (string(fitres->GetTitle()) == fast_fit_title) ? "fast" : roofit_backend_description();
+}
+
+//Fits with fast_binned_fit.h and returns the result as a RooFitResult. Returns NULL if it did not converge
+RooFitResult* fit_fast_backend(RooSimultaneous& simPdf, RooDataHist& combData, string model_name)
+{
+	RooRealVar*   vars[kNFastFitParameters];
+	FastBinnedNLL nll = make_fast_nll(simPdf, combData, model_name, vars);
+
+	//Starts from the values in the RooRealVars, so warm start works the same way
+	double start[kNFastFitParameters], step[kNFastFitParameters], lower[kNFastFitParameters], upper[kNFastFitParameters];
+	for (int i = 0; i < kNFastFitParameters; i++)
+	{
+		start[i] = vars[i]->getVal();
+		lower[i] = vars[i]->getMin();
+		upper[i] = vars[i]->getMax();
+		step[i]  = (vars[i]->getError() > 0.) ? vars[i]->getError() : 0.1*(upper[i] - lower[i]);
+	}
+
+	FastFitResult result = fast_binned_fit(nll, start, step, lower, upper);
+	last_fit_nll_calls = result.ncalls;
+	cout << "Fast backend: status " << result.status << ", " << result.ncalls << " NLL evaluations\n";
+
+	RooFitResult* fitres = NULL;
+	if (result.status == 0)
+	{
+		//Stores the result in the RooRealVars, so the rest of doFit works as with RooFit
+		for (int i = 0; i < kNFastFitParameters; i++)
+		{
+			vars[i]->setVal  (result.values[i]);
+			vars[i]->setError(result.errors[i]);
+		}
+		RooArgSet* params = simPdf.getParameters(combData);
+		fitres = RooFitResult::prefitResult(RooArgList(*params));
+		fitres->SetName (fast_fit_title);
+		fitres->SetTitle(fast_fit_title);
+		delete params;
+	}
+
+	return fitres;
+}
+
+//Same steps of fitTo (Migrad, then Hesse), but with the likelihood options of this run and counting its evaluations
+//strategy is the Minuit strategy: 1 is the default, 2 is slower and more careful (used by the refits of fit_health.h)
+RooFitResult* fit_roofit_backend(RooSimultaneous& simPdf, RooDataHist& combData, int strategy = 1)
+{
+	RooLinkedList nll_options;
+	RooCmdArg extended = RooFit::Extended(true);
+	nll_options.Add(&extended);
+
+	RooCmdArg num_cpu = RooFit::NumCPU(roofit_num_cpu);
+	if (roofit_num_cpu > 1)
+		nll_options.Add(&num_cpu);
+
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,30,0)
+	string eval_backend = roofit_eval_backend;
+	if (roofit_num_cpu > 1 && eval_backend != "legacy")
+	{
+		cout << "RooFit::NumCPU only works with the legacy backend. Using it instead of \"" << eval_backend << "\"\n";
+		eval_backend = "legacy";
+	}
+	RooCmdArg eval = RooFit::EvalBackend(eval_backend);
+	if (eval_backend != "")
+		nll_options.Add(&eval);
+#else
+	//Before ROOT 6.30 the vectorized evaluation was called BatchMode
+	RooCmdArg batch_mode = RooFit::BatchMode(true);
+	if (roofit_eval_backend == "cpu")
+		nll_options.Add(&batch_mode);
+	else if (roofit_eval_backend != "" && roofit_eval_backend != "legacy")
+		cout << "Evaluation backend \"" << roofit_eval_backend << "\" needs ROOT 6.30 or newer. Using the default one\n";
+#endif
+
+	RooAbsReal* nll = simPdf.createNLL(combData, nll_options);
+
+	//Hesse always runs after Migrad, as in fitTo, so errors and status are the ones fitTo would give even when Migrad fails
+	RooMinimizer minimizer(*nll);
+	minimizer.setStrategy(strategy);
+	int migrad_status = minimizer.migrad();
+	minimizer.hesse();
+	last_fit_nll_calls = minimizer.evalCounter();
+
+	RooFitResult* fitres = minimizer.save();
+	cout << "RooFit backend (" << roofit_backend_description() << ", strategy " << strategy << "): status " << fitres->status()
+		<< " (Migrad " << migrad_status << "), " << last_fit_nll_calls << " NLL evaluations\n";
+
+	delete nll;
+	return fitres;
+}
+
+//Minimizes the likelihood with the backend chosen by fit_backend
+RooFitResult* run_fit(RooSimultaneous& simPdf, RooDataHist& combData, string model_name)
+{
+	string refusal = (fit_backend == "fast") ? fast_backend_refusal(model_name) : "";
+	if (refusal != "")
+		cout << refusal << ". Fitting with RooFit\n";
+	else if (fit_backend == "fast")
+	{
+		RooFitResult* fitres = fit_fast_backend(simPdf, combData, model_name);
+		if (fitres != NULL)
+			return fitres;
+
+		cout << "Fast backend did not converge. Fitting again with RooFit\n";
+	}
+
+	return fit_roofit_backend(simPdf, combData);
+}
+#endif
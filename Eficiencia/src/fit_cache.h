@@ -0,0 +1,132 @@
+#ifndef FIT_CACHE_HEADER
+#define FIT_CACHE_HEADER
+#include "bin_histograms.h"
+
+//Folder where every fit result is stored to be reused when nothing changed
+//It is not inside results/bins_fit/ because create_folder(..., true) deletes those folders
+string fit_cache_folder = "results/fit_cache/";
+
+//Set it false to always fit again
+bool use_fit_cache = true;
+
+//Also stores the RooPlots, so the png files can be recreated on a cache hit with fit_plot_mode = "inline"
+bool fit_cache_store_plots = false;
+
+//Describes everything that changes the fit result. Its hash is the name of the cache file
+//backend is fit_backend_description of the model to look for a fit, fit_result_backend of the result to store one
+string fit_cache_description(const char* data_path, string condition, string MuonId, string model_definition, string backend)
+{
+	//File identity: if a data file or a source it reads is replaced, added or removed, the list, sizes or modification times change
+	//On incremental mode the content of the histograms is used instead, so only bins that changed are fitted again
+	string description;
+	if (use_incremental_partials)
+		description += bin_histograms_description(data_path, condition, MuonId);
+	else for (string data_file : expand_data_files(data_path))
+		description += string("data: ") + data_file_identity(data_file) + "\n";
+	description += string("probes: ")    + tag_cut + " && " + condition + " && " + MuonId + "\n";
+	description += string("ranges: ")    + probe_ranges + " (edges in float)\n";
+	description += string("model: ")     + model_definition + "\n";
+	description += string("fit range: ") + to_string(_mmin) + " " + to_string(_mmax) + "\n";
+	description += string("fit bins: ")  + to_string(mass_bins()) + "\n";
+	description += string("backend: ")   + backend + "\n";
+	return description;
+}
+
+string fit_cache_path(string description)
+{
+	TMD5 md5;
+	md5.Update((const UChar_t*)description.data(), description.size());
+	md5.Final();
+	return fit_cache_folder + md5.AsString() + ".root";
+}
+
+//Returns true and fills [yield_all, yield_pass, err_all, err_pass] if the fit is in cache
+bool fit_cache_load(string description, YieldsNErrs& output, const char* savePath, string condition)
+{
+	if (!use_fit_cache)
+		return false;
+
+	string cache_path = fit_cache_path(description);
+	if (gSystem->AccessPathName(cache_path.c_str()))
+		return false;
+
+	TDirectory* previous_dir = gDirectory;
+	TFile* cache_file = TFile::Open(cache_path.c_str());
+	previous_dir->cd();
+	if (cache_file == NULL || cache_file->IsZombie())
+	{
+		delete cache_file;
+		return false;
+	}
+
+	TVectorD*     yields_n_errs = (TVectorD*)    cache_file->Get("yields_n_errs");
+	RooFitResult* fitres        = (RooFitResult*)cache_file->Get("fitres");
+	TObjString*   stored_desc   = (TObjString*)  cache_file->Get("description");
+
+	//Protects against hash collisions and half written files
+	if (yields_n_errs == NULL || fitres == NULL || stored_desc == NULL || stored_desc->GetString() != description.c_str())
+	{
+		delete yields_n_errs;
+		delete fitres;
+		delete stored_desc;
+		delete cache_file;
+		return false;
+	}
+
+	for (int i = 0; i < 4; i++)
+		output[i] = (*yields_n_errs)[i];
+
+	cout << "Fit loaded from cache: " << cache_path << " (fit status " << fitres->status() << ")\n";
+
+	//Keeps warm start working for the next fits
+	delete last_fit_result;
+	last_fit_result = fitres;
+	last_fit_result->SetName("last_fit_result");
+
+	//The cache entry is also a snapshot that render_fits.cpp can draw
+	if (savePath != NULL && fit_plot_mode == "deferred")
+		gSystem->CopyFile(cache_path.c_str(), (string(savePath) + condition + ".root").c_str(), kTRUE);
+
+	RooPlot* frame      = (RooPlot*)cache_file->Get("frame_all");
+	RooPlot* frame_pass = (RooPlot*)cache_file->Get("frame_pass");
+	if (savePath != NULL && fit_plot_mode == "inline" && frame != NULL && frame_pass != NULL)
+	{
+		TCanvas* c_cache = new TCanvas;
+		frame_pass->Draw();
+		c_cache->SaveAs((string(savePath) + condition + "_PASS.png").c_str());
+		frame->Draw();
+		c_cache->SaveAs((string(savePath) + condition + "_ALL.png").c_str());
+		delete c_cache;
+	}
+
+	delete frame;
+	delete frame_pass;
+	delete yields_n_errs;
+	delete stored_desc;
+	delete cache_file;
+	return true;
+}
+
+void fit_cache_store(string description, const YieldsNErrs& output, RooFitResult* fitres, TH1* hist_all, TH1* hist_pass, string model_name,
+	string condition, RooPlot* frame = NULL, RooPlot* frame_pass = NULL)
+{
+	if (!use_fit_cache)
+		return;
+
+	if (gSystem->AccessPathName(fit_cache_folder.c_str()))
+		gSystem->mkdir(fit_cache_folder.c_str(), true);
+
+	if (!fit_cache_store_plots)
+	{
+		frame      = NULL;
+		frame_pass = NULL;
+	}
+
+	//Writes on a temporary file and renames it, so a crash never leaves a broken cache entry
+	string cache_path = fit_cache_path(description);
+	string temp_path  = cache_path + ".tmp";
+
+	if (write_fit_record(temp_path, output, fitres, hist_all, hist_pass, model_name, condition, frame, frame_pass, description))
+		gSystem->Rename(temp_path.c_str(), cache_path.c_str());
+}
+#endif
@@ -0,0 +1,232 @@
+#ifndef FIT_HEALTH_HEADER
+#define FIT_HEALTH_HEADER
+//Health of every fit of doFit: Minuit status, covariance quality, EDM and yields stuck at a limit (0 or the entries of the histogram)
+//A bin that fails is fitted again only with the strategies of refit_strategies, in order, until one is healthy
+//Fits with problems in the fit cache are fitted again too, so running the scan again only refits the bins that failed
+//Include it after warm_start.h
+
+//Set it false to only classify the fits
+bool refit_failing_bins = true;
+
+//Refits of a failing bin, in order:
+//"strategy2" Minuit strategy 2 starting from the failed fit
+//"restart"   strategy 2 from the initial values, with most of the entries as signal
+//"tight"     strategy 2 from the initial values, with the shape parameters limited around them
+vector<string> refit_strategies = {"strategy2", "restart", "tight"};
+
+//Largest EDM of a healthy fit
+double fit_health_max_edm = 1e-3;
+
+//A yield closer to a limit than this fraction of its range is stuck at it
+//The signal at its maximum (every entry) is only a problem if its background is not at 0, otherwise the bin is just free of background
+double yield_limit_tolerance = 1e-4;
+
+//Fraction of the range of each shape parameter kept around its initial value by "tight"
+double tight_range_fraction = 0.2;
+
+//Yields of doFit
+const char* fit_yield_names[] = {"n_signal_total", "n_signal_total_pass", "n_back", "n_back_pass"};
+
+bool is_fit_yield(string name)
+{
+	for (const char* yield_name : fit_yield_names)
+		if (name == yield_name)
+			return true;
+	return false;
+}
+
+//The fast backend result has no covariance quality or EDM (see fit_backend.h)
+//Fast results cached before they had their title only kept the title of RooFitResult::prefitResult
+bool has_minuit_quality(const RooFitResult* fitres)
+{
+	string title = fitres->GetTitle();
+	return title != fast_fit_title && title != "prefitResult";
+}
+
+//Yield closer to its limit than yield_limit_tolerance of its range: -1 at its minimum, 1 at its maximum, 0 if it is not
+int yield_at_limit(const RooRealVar* yield)
+{
+	double tolerance = yield_limit_tolerance*(yield->getMax() - yield->getMin());
+	if (yield->getVal() - yield->getMin() <= tolerance)
+		return -1;
+	if (yield->getMax() - yield->getVal() <= tolerance)
+		return 1;
+	return 0;
+}
+
+//Problems of a fit separated by commas, empty if it is healthy
+string fit_problems(const RooFitResult* fitres)
+{
+	vector<string> problems;
+	if (fitres->status() != 0)
+		problems.push_back("status " + to_string(fitres->status()));
+	if (has_minuit_quality(fitres) && fitres->covQual() < 3)
+		problems.push_back("covariance quality " + to_string(fitres->covQual()));
+	if (has_minuit_quality(fitres) && fitres->edm() > fit_health_max_edm)
+		problems.push_back("EDM " + to_string(fitres->edm()));
+
+	//Each signal yield with the background yield of the same category
+	for (auto yield_names : {make_pair("n_signal_total", "n_back"), make_pair("n_signal_total_pass", "n_back_pass")})
+	{
+		RooRealVar* yield      = (RooRealVar*)fitres->floatParsFinal().find(yield_names.first);
+		RooRealVar* background = (RooRealVar*)fitres->floatParsFinal().find(yield_names.second);
+		if (yield == NULL)
+			continue;
+
+		int limit = yield_at_limit(yield);
+		if (limit < 0)
+			problems.push_back(string(yield_names.first) + " at its minimum");
+		else if (limit > 0 && (background == NULL || yield_at_limit(background) >= 0))
+			problems.push_back(string(yield_names.first) + " at its maximum");
+	}
+
+	string joined;
+	for (size_t i = 0; i < problems.size(); i++)
+		joined += (i > 0 ? ", " : "") + problems[i];
+	return joined;
+}
+
+//Health of a fit for FitInfo
+FitInfo fit_health_info(const RooFitResult* fitres, double seconds, int refits = 0, string strategy = "")
+{
+	FitInfo info;
+	info.status      = fitres->status();
+	info.seconds     = seconds;
+	info.cov_quality = has_minuit_quality(fitres) ? fitres->covQual() : -1;
+	info.edm         = has_minuit_quality(fitres) ? fitres->edm()     : -1.;
+	info.refits      = refits;
+	info.strategy    = strategy;
+	info.problems    = fit_problems(fitres);
+	return info;
+}
+
+//Sets the parameters to the starting values of a refit strategy
+void prepare_refit(string strategy, RooArgSet* params, const RooArgSet* initial)
+{
+	if (strategy == "strategy2")
+		return;
+
+	restore_parameters(params, initial);
+	for (RooAbsArg* arg : *params)
+	{
+		RooRealVar* par = dynamic_cast<RooRealVar*>(arg);
+		if (par == NULL || par->isConstant())
+			continue;
+
+		string name = par->GetName();
+		if (strategy == "restart" && is_fit_yield(name))
+			par->setVal((name.find("signal") != string::npos ? 0.8 : 0.2)*par->getMax());
+		else if (strategy == "tight" && !is_fit_yield(name))
+		{
+			double half_width = 0.5*tight_range_fraction*(par->getMax() - par->getMin());
+			par->setRange(max(par->getMin(), par->getVal() - half_width), min(par->getMax(), par->getVal() + half_width));
+		}
+	}
+}
+
+//Fits again a bin with problems with each strategy of refit_strategies until one is healthy
+//Returns the healthiest result (the first healthy one, else the last that converged, else fitres) and deletes the others
+//The parameters of the model are left with the values of the returned result
+RooFitResult* refit_failing_bin(RooSimultaneous& simPdf, RooDataHist& combData, RooFitResult* fitres, const RooArgSet* initial, FitInfo& info)
+{
+	RooArgSet* params = simPdf.getParameters(combData);
+	RooFitResult* kept = fitres;
+	info.refits = 0;
+
+	for (string strategy : refit_strategies)
+	{
+		if (info.problems == "")
+			break;
+
+		if (strategy != "strategy2" && strategy != "restart" && strategy != "tight")
+		{
+			cerr << "Unknown refit strategy \"" << strategy << "\". Use \"strategy2\", \"restart\" or \"tight\"\n";
+			abort();
+		}
+
+		cout << "Fit has problems (" << info.problems << "). Refitting with \"" << strategy << "\"\n";
+		RooArgSet kept_values(kept->floatParsFinal());
+		restore_parameters(params, &kept_values);
+		prepare_refit(strategy, params, initial);
+
+		RooFitResult* refit    = fit_roofit_backend(simPdf, combData, 2);
+		string        problems = fit_problems(refit);
+		info.refits++;
+
+		if (problems == "" || (refit->status() == 0 && kept->status() != 0))
+		{
+			if (kept != fitres)
+				delete kept;
+			kept          = refit;
+			info.strategy = strategy;
+			info.problems = problems;
+		}
+		else
+			delete refit;
+	}
+
+	//Parameters and warm start seed from the result that is kept
+	RooArgSet kept_values(kept->floatParsFinal());
+	restore_parameters(params, &kept_values);
+	if (kept != fitres)
+	{
+		delete fitres;
+		delete last_fit_result;
+		last_fit_result = (RooFitResult*)kept->Clone("last_fit_result");
+	}
+	info = fit_health_info(kept, info.seconds, info.refits, info.strategy);
+
+	delete params;
+	return kept;
+}
+
+//Table of the health of every fit on the current directory, written with it, and its summary on the output
+//fit_info has the fits of each variation, in the order of conditions
+void write_fit_health(const vector<string>& variation_names, const vector<vector<FitInfo>>& fit_info, const vector<string>& conditions)
+{
+	string variation, condition, strategy, problems;
+	int    bin, status, cov_quality, refits;
+	double edm, seconds;
+
+	TTree* tree = new TTree("fit_health", "Health of every fit");
+	tree->Branch("variation",   &variation);
+	tree->Branch("bin",         &bin,         "bin/I");
+	tree->Branch("condition",   &condition);
+	tree->Branch("status",      &status,      "status/I");
+	tree->Branch("cov_quality", &cov_quality, "cov_quality/I");
+	tree->Branch("edm",         &edm,         "edm/D");
+	tree->Branch("refits",      &refits,      "refits/I");
+	tree->Branch("strategy",    &strategy);
+	tree->Branch("problems",    &problems);
+	tree->Branch("seconds",     &seconds,     "seconds/D");
+
+	int nfits = 0, nrecovered = 0;
+	vector<string> failing;
+	for (size_t v = 0; v < fit_info.size(); v++)
+		for (size_t i = 0; i < fit_info[v].size() && i < conditions.size(); i++)
+		{
+			const FitInfo& info = fit_info[v][i];
+			variation   = variation_names[v];
+			bin         = i;
+			condition   = conditions[i];
+			status      = info.status;
+			cov_quality = info.cov_quality;
+			edm         = info.edm;
+			refits      = info.refits;
+			strategy    = info.strategy;
+			problems    = info.problems;
+			seconds     = info.seconds;
+			tree->Fill();
+
+			nfits++;
+			if (info.problems != "")
+				failing.push_back(variation + " bin " + to_string(i) + ": " + info.problems);
+			else if (info.strategy != "")
+				nrecovered++;
+		}
+
+	cout << "\nFit health: " << nfits - failing.size() << " of " << nfits << " fits healthy, " << nrecovered << " recovered by refits\n";
+	for (string fail : failing)
+		cout << "  " << fail << "\n";
+}
+#endif
@@ -0,0 +1,51 @@
+#ifndef FIT_SNAPSHOT_HEADER
+#define FIT_SNAPSHOT_HEADER
+//How the plots of every fit are made:
+//"inline"   draws and saves the png files inside doFit (slow)
+//"deferred" only saves a snapshot (.root) with the binned data and fit result, render_fits.cpp draws it later
+//"none"     does not save anything
+string fit_plot_mode = "deferred";
+
+//Writes everything needed to draw a fit later without fitting it again
+bool write_fit_record(string path, const YieldsNErrs& output, RooFitResult* fitres, TH1* hist_all, TH1* hist_pass, string model_name,
+	string condition, RooPlot* frame = NULL, RooPlot* frame_pass = NULL, string description = "")
+{
+	TDirectory* previous_dir = gDirectory;
+	TFile* record_file = TFile::Open(path.c_str(), "RECREATE");
+	if (record_file == NULL || record_file->IsZombie())
+	{
+		cerr << "Could not write \"" << path << "\" file\n";
+		delete record_file;
+		previous_dir->cd();
+		return false;
+	}
+
+	TVectorD   yields_n_errs(4, output.data());
+	TNamed     model("model", model_name.c_str());
+	TObjString stored_condition(condition.c_str());
+	yields_n_errs   .Write("yields_n_errs");
+	model           .Write("model");
+	stored_condition.Write("condition");
+	fitres   ->Write("fitres");
+	hist_all ->Write("hist_all");
+	hist_pass->Write("hist_pass");
+
+	if (description != "")
+	{
+		TObjString stored_desc(description.c_str());
+		stored_desc.Write("description");
+	}
+
+	if (frame != NULL && frame_pass != NULL)
+	{
+		frame     ->Write("frame_all");
+		frame_pass->Write("frame_pass");
+	}
+
+	record_file->Close();
+	delete record_file;
+	previous_dir->cd();
+	return true;
+}
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef FIT_YIELDS_HEADER
+#define FIT_YIELDS_HEADER
+//Result of a fit: [yield_all, yield_pass, err_all, err_pass]
+//It is a value, so results are copied and kept in vectors with nothing to delete
+typedef array<double, 4> YieldsNErrs;
+
+//Status of a fit (from Minuit, 0 is converged), its time and its health (src/fit_health.h)
+//Status is -1 when the result was not fitted here: read from the fit cache, a checkpoint or a work queue
+struct FitInfo
+{
+	int    status;
+	double seconds;
+	int    cov_quality;  //Of the covariance matrix, 3 is accurate. -1 if unknown
+	double edm;
+	int    refits;       //Refits made because the first fit had problems
+	string strategy;     //Refit strategy of the result, empty if it is the first fit
+	string problems;     //Empty if the fit is healthy
+};
+#endif
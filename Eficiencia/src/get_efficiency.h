@@ -57,8 +57,7 @@ TEfficiency* get_efficiency(TH1D* all, TH1D* pass, string quantity, int nbins, s
 	}
 	cout << "Eficiencia = "<< soma/nbins << endl;
 
-	ofstream fout("Eficiencia_valor.txt", ios::app); 
-	fout << "Eficiencia " + MuonId + "_" + quantity + " = " + soma/nbins << endl;
+	//Values of every bin are recorded on the results store (src/results_store.h) by the macros
 	
 	return pEff;
 }
@@ -0,0 +1,80 @@
+#ifndef MEMORY_MONITOR_HEADER
+#define MEMORY_MONITOR_HEADER
+//Resident memory (RSS) of the process, checked after every fit so long scans can be seen to stay flat
+
+//Prints the RSS after every fit
+bool print_memory = false;
+
+//Warns when the RSS grew more than this (MB) since the first fit. 0 never warns
+double memory_growth_warning = 200.;
+
+//If the RSS is above this (MB) after a fit, datasets are released from the least recently used one until it is below
+//The dataset of the last fit is kept, partials are released only if that is not enough. 0 never releases
+//Useful when several workers share a node. They are loaded again by the next fit that needs them
+double memory_limit = 0.;
+
+double first_fit_memory    = 0.;
+double peak_fit_memory     = 0.;
+int    fits_monitored      = 0;
+bool   memory_warned       = false;
+bool   memory_limit_warned = false;
+
+//RSS in MB
+double resident_memory()
+{
+	ProcInfo_t info;
+	gSystem->GetProcInfo(&info);
+	return info.fMemResident/1024.;
+}
+
+void monitor_memory()
+{
+	double memory = resident_memory();
+	if (fits_monitored++ == 0)
+		first_fit_memory = memory;
+	peak_fit_memory = max(peak_fit_memory, memory);
+
+	if (print_memory)
+		cout << "Memory after fit " << fits_monitored << ": " << memory << " MB (" << memory - first_fit_memory << " MB since the first fit)\n";
+
+	if (memory_growth_warning > 0. && memory - first_fit_memory > memory_growth_warning && !memory_warned)
+	{
+		cout << "WARNING: memory grew " << memory - first_fit_memory << " MB in " << fits_monitored << " fits\n";
+		memory_warned = true;
+	}
+
+	if (memory_limit > 0. && memory > memory_limit)
+	{
+		while (memory > memory_limit && loaded_probe_datasets.size() > 1)
+		{
+			string data_path = least_recently_used_dataset();
+			release_dataset_selections(data_path);
+			release_probe_dataset(data_path);
+			cout << "Memory above " << memory_limit << " MB (" << memory << " MB). Released \"" << data_path << "\", now ";
+			memory = resident_memory();
+			cout << memory << " MB\n";
+		}
+
+		if (memory > memory_limit && !loaded_partials.empty())
+		{
+			release_partials();
+			memory = resident_memory();
+			cout << "Memory above " << memory_limit << " MB. Released partials, now " << memory << " MB\n";
+		}
+
+		if (memory > memory_limit && !memory_limit_warned)
+		{
+			cout << "WARNING: memory still above " << memory_limit << " MB (" << memory << " MB) with only the data of the last fit loaded."
+				" Raise the limit or use fewer workers on this node\n";
+			memory_limit_warned = true;
+		}
+	}
+}
+
+string memory_summary()
+{
+	char summary[128];
+	snprintf(summary, sizeof(summary), "%.0f MB after the first of %d fits, %.0f MB at peak", first_fit_memory, fits_monitored, peak_fit_memory);
+	return summary;
+}
+#endif
@@ -0,0 +1,391 @@
+#ifndef PROBE_COLUMNS_HEADER
+#define PROBE_COLUMNS_HEADER
+//Columns of the tag and probe tree used by doFit, as contiguous arrays that can be mapped from disk
+//convert_to_columnar.cpp writes them once. After that, loading a file is only a mmap, without reading or decompressing
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <map>
+
+#include "ROOT/TThreadExecutor.hxx"
+
+#include "data_files.h"
+#include "probe_kernel.h"
+
+//Kinematic columns in float and one bit plane per muon id (bit i of word i/64 is the probe i)
+enum ProbeColumnArray
+{
+	kInvariantMass, kProbeMuon_Pt, kProbeMuon_Eta, kProbeMuon_Phi, kTagMuon_Pt, kTagMuon_Eta, kTagMuon_Phi,
+	kPassingTracking, kPassingStandAlone, kPassingGlobal,
+	kNProbeColumnArrays
+};
+const int kNFloatColumns = kPassingTracking;
+
+//Every array starts on a cache line
+const long long columnar_alignment = 64;
+
+//Start of the columnar file. The arrays follow at the given offsets from the start of the file
+struct ColumnarHeader
+{
+	char      magic[8];
+	long long entries;
+	long long offsets[kNProbeColumnArrays];
+	long long size;
+};
+const char columnar_magic[8] = {'T', 'N', 'P', 'C', 'O', 'L', 'S', '1'};
+
+long long columnar_aligned(long long offset)
+{
+	return (offset + columnar_alignment - 1)/columnar_alignment*columnar_alignment;
+}
+
+//Fills the header with the position of every array for this number of entries
+void columnar_layout(ColumnarHeader* header, long long entries)
+{
+	memcpy(header->magic, columnar_magic, sizeof(columnar_magic));
+	header->entries = entries;
+
+	long long offset = columnar_aligned(sizeof(ColumnarHeader));
+	for (int i = 0; i < kNProbeColumnArrays; i++)
+	{
+		header->offsets[i] = offset;
+		if (i < kNFloatColumns)
+			offset = columnar_aligned(offset + entries*sizeof(float));
+		else
+			offset = columnar_aligned(offset + (entries + 63)/64*sizeof(unsigned long long));
+	}
+	header->size = offset;
+}
+
+//Points the arrays of columns to the memory, which starts with a ColumnarHeader
+void attach_columns(ProbeColumns* columns, void* memory, size_t memory_size)
+{
+	const ColumnarHeader* header = (const ColumnarHeader*)memory;
+	const char* base = (const char*)memory;
+
+	columns->entries       = header->entries;
+	columns->InvariantMass = (const float*)(base + header->offsets[kInvariantMass]);
+	columns->ProbeMuon_Pt  = (const float*)(base + header->offsets[kProbeMuon_Pt]);
+	columns->ProbeMuon_Eta = (const float*)(base + header->offsets[kProbeMuon_Eta]);
+	columns->ProbeMuon_Phi = (const float*)(base + header->offsets[kProbeMuon_Phi]);
+	columns->TagMuon_Pt    = (const float*)(base + header->offsets[kTagMuon_Pt]);
+	columns->TagMuon_Eta   = (const float*)(base + header->offsets[kTagMuon_Eta]);
+	columns->TagMuon_Phi   = (const float*)(base + header->offsets[kTagMuon_Phi]);
+	for (int bit = 0; bit < 3; bit++)
+		columns->passing[bit] = (const unsigned long long*)(base + header->offsets[kPassingTracking + bit]);
+
+	columns->memory      = memory;
+	columns->memory_size = memory_size;
+}
+
+//Reads the tree into anonymous memory with the same layout of the columnar file
+ProbeColumns* read_probe_tree(const char* path)
+{
+	TFile* file0 = TFile::Open(path);
+	if (file0 == NULL || file0->IsZombie())
+	{
+		cerr << "Could not open \"" << path << "\" file\n";
+		abort();
+	}
+	TTree* DataTree = (TTree*)file0->Get("tagandprobe");
+
+	double InvariantMass, ProbeMuon_Pt, ProbeMuon_Eta, ProbeMuon_Phi, TagMuon_Pt, TagMuon_Eta, TagMuon_Phi;
+	int    PassingProbeTrackingMuon, PassingProbeStandAloneMuon, PassingProbeGlobalMuon;
+
+	DataTree->SetBranchStatus("*", 0);
+	const char* branches[] = {"InvariantMass", "ProbeMuon_Pt", "ProbeMuon_Eta", "ProbeMuon_Phi", "TagMuon_Pt", "TagMuon_Eta", "TagMuon_Phi",
+		"PassingProbeTrackingMuon", "PassingProbeStandAloneMuon", "PassingProbeGlobalMuon"};
+	for (const char* branch : branches)
+		DataTree->SetBranchStatus(branch, 1);
+
+	DataTree->SetBranchAddress("InvariantMass",              &InvariantMass);
+	DataTree->SetBranchAddress("ProbeMuon_Pt",               &ProbeMuon_Pt);
+	DataTree->SetBranchAddress("ProbeMuon_Eta",              &ProbeMuon_Eta);
+	DataTree->SetBranchAddress("ProbeMuon_Phi",              &ProbeMuon_Phi);
+	DataTree->SetBranchAddress("TagMuon_Pt",                 &TagMuon_Pt);
+	DataTree->SetBranchAddress("TagMuon_Eta",                &TagMuon_Eta);
+	DataTree->SetBranchAddress("TagMuon_Phi",                &TagMuon_Phi);
+	DataTree->SetBranchAddress("PassingProbeTrackingMuon",   &PassingProbeTrackingMuon);
+	DataTree->SetBranchAddress("PassingProbeStandAloneMuon", &PassingProbeStandAloneMuon);
+	DataTree->SetBranchAddress("PassingProbeGlobalMuon",     &PassingProbeGlobalMuon);
+
+	ColumnarHeader header;
+	columnar_layout(&header, DataTree->GetEntries());
+
+	//Anonymous memory comes zeroed, so only the passing bits have to be set
+	void* memory = mmap(NULL, header.size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (memory == MAP_FAILED)
+	{
+		cerr << "Could not allocate " << header.size << " bytes for the columns of \"" << path << "\"\n";
+		abort();
+	}
+	memcpy(memory, &header, sizeof(header));
+
+	char* base = (char*)memory;
+	float* floats[kNFloatColumns];
+	for (int i = 0; i < kNFloatColumns; i++)
+		floats[i] = (float*)(base + header.offsets[i]);
+	unsigned long long* planes[3];
+	for (int bit = 0; bit < 3; bit++)
+		planes[bit] = (unsigned long long*)(base + header.offsets[kPassingTracking + bit]);
+
+	cout << "Reading " << header.entries << " probes from \"" << path << "\"\n";
+	for (long long i = 0; i < header.entries; i++)
+	{
+		DataTree->GetEntry(i);
+		floats[kInvariantMass][i] = InvariantMass;
+		floats[kProbeMuon_Pt] [i] = ProbeMuon_Pt;
+		floats[kProbeMuon_Eta][i] = ProbeMuon_Eta;
+		floats[kProbeMuon_Phi][i] = ProbeMuon_Phi;
+		floats[kTagMuon_Pt]   [i] = TagMuon_Pt;
+		floats[kTagMuon_Eta]  [i] = TagMuon_Eta;
+		floats[kTagMuon_Phi]  [i] = TagMuon_Phi;
+		planes[0][i >> 6] |= (unsigned long long)(PassingProbeTrackingMuon   == 1) << (i & 63);
+		planes[1][i >> 6] |= (unsigned long long)(PassingProbeStandAloneMuon == 1) << (i & 63);
+		planes[2][i >> 6] |= (unsigned long long)(PassingProbeGlobalMuon     == 1) << (i & 63);
+	}
+
+	delete file0;
+
+	ProbeColumns* columns = new ProbeColumns;
+	attach_columns(columns, memory, header.size);
+	return columns;
+}
+
+//Path of the columnar file made from a .root file
+string columnar_path(const char* path)
+{
+	string columnar = path;
+	if (columnar.size() > 5 && columnar.substr(columnar.size() - 5) == ".root")
+		columnar.erase(columnar.size() - 5);
+	return columnar + ".cols";
+}
+
+//Writes the columns to a columnar file. Returns false if it could not be written
+bool write_columnar(const ProbeColumns* columns, string path)
+{
+	string temp_path = path + ".tmp";
+	FILE* file = fopen(temp_path.c_str(), "wb");
+	if (file == NULL)
+	{
+		cerr << "Could not write \"" << temp_path << "\" file\n";
+		return false;
+	}
+
+	bool written = (fwrite(columns->memory, 1, columns->memory_size, file) == columns->memory_size);
+	written = (fclose(file) == 0) && written;
+	if (!written || rename(temp_path.c_str(), path.c_str()) != 0)
+	{
+		cerr << "Could not write \"" << path << "\" file\n";
+		remove(temp_path.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+//Maps a columnar file. Returns NULL if it does not exist or is not valid
+ProbeColumns* map_columnar(string path)
+{
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return NULL;
+
+	struct stat file_stat;
+	fstat(fd, &file_stat);
+	size_t size = file_stat.st_size;
+
+	void* memory = (size >= sizeof(ColumnarHeader)) ? mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+	close(fd);
+	if (memory == MAP_FAILED)
+		return NULL;
+
+	const ColumnarHeader* header = (const ColumnarHeader*)memory;
+	if (memcmp(header->magic, columnar_magic, sizeof(columnar_magic)) != 0 || header->size != (long long)size)
+	{
+		cerr << "\"" << path << "\" is not a valid columnar file. Convert it again with convert_to_columnar.cpp\n";
+		munmap(memory, size);
+		return NULL;
+	}
+
+	//Selections go through the whole file, so the kernel can read ahead
+	madvise(memory, size, MADV_WILLNEED);
+
+	ProbeColumns* columns = new ProbeColumns;
+	attach_columns(columns, memory, size);
+	cout << "Mapped " << columns->entries << " probes from \"" << path << "\"\n";
+	return columns;
+}
+
+//Uses the columnar file next to the .root file if it is newer than it and than its sources (see data_files.h). Otherwise reads the tree
+ProbeColumns* open_probe_columns(const char* path)
+{
+	string columnar = columnar_path(path);
+	FileStat_t columnar_stat;
+	bool has_columnar = (gSystem->GetPathInfo(columnar.c_str(), columnar_stat) == 0);
+	bool up_to_date   = has_columnar && columnar_stat.fMtime >= data_file_mtime(path);
+
+	ProbeColumns* columns = NULL;
+	if (up_to_date)
+		columns = map_columnar(columnar);
+	else if (has_columnar)
+		cout << "\"" << columnar << "\" is older than \"" << path << "\" or its sources. Convert it again with convert_to_columnar.cpp\n";
+
+	if (columns == NULL)
+		columns = read_probe_tree(path);
+
+	return columns;
+}
+
+//Unmaps the memory of the columns, mapped or anonymous
+void close_probe_columns(ProbeColumns* columns)
+{
+	munmap(columns->memory, columns->memory_size);
+	delete columns;
+}
+
+//Columns already loaded, by file path
+map<string, ProbeColumns*> loaded_probe_columns;
+
+ProbeColumns* load_probe_columns(const char* path)
+{
+	auto found = loaded_probe_columns.find(path);
+	if (found != loaded_probe_columns.end())
+		return found->second;
+
+	ProbeColumns* columns = open_probe_columns(path);
+	loaded_probe_columns[path] = columns;
+	return columns;
+}
+
+//Columns of every input file. Each file keeps its own arrays, so files are read and selected independently
+typedef vector<ProbeColumns*> ProbeDataset;
+
+//Threads reading and selecting the input files. 0 uses every core
+int data_threads = 0;
+
+ROOT::TThreadExecutor& data_pool()
+{
+	static ROOT::TThreadExecutor* pool = NULL;
+	if (pool == NULL)
+	{
+		ROOT::EnableThreadSafety();
+		pool = new ROOT::TThreadExecutor(data_threads);
+	}
+	return *pool;
+}
+
+//Calls work(i) for i in [0, n) on the threads of data_pool
+void for_each_task(unsigned n, function<void(unsigned)> work)
+{
+	if (n == 1 || data_threads == 1)
+	{
+		for (unsigned i = 0; i < n; i++)
+			work(i);
+		return;
+	}
+	data_pool().Foreach(work, ROOT::TSeqU(n));
+}
+
+//Calls work(i) for i in [0, n), one file per thread
+void for_each_file(unsigned n, function<void(unsigned)> work)
+{
+	for_each_task(n, work);
+}
+
+//Datasets already loaded, by data path (see data_files.h)
+map<string, ProbeDataset> loaded_probe_datasets;
+
+//Order of the last use of every loaded dataset, so the least recently used one is released first
+map<string, long long> probe_dataset_last_use;
+long long              probe_dataset_uses = 0;
+
+const ProbeDataset& load_probe_dataset(const char* data_path)
+{
+	probe_dataset_last_use[data_path] = ++probe_dataset_uses;
+
+	auto found = loaded_probe_datasets.find(data_path);
+	if (found != loaded_probe_datasets.end())
+		return found->second;
+
+	vector<string> files = expand_data_files(data_path);
+	ProbeDataset dataset(files.size(), NULL);
+
+	//Files already loaded by another data path are reused, the others are read in parallel
+	for (size_t i = 0; i < files.size(); i++)
+		if (loaded_probe_columns.find(files[i]) != loaded_probe_columns.end())
+			dataset[i] = loaded_probe_columns[files[i]];
+
+	for_each_file(files.size(), [&](unsigned i)
+	{
+		if (dataset[i] == NULL)
+			dataset[i] = open_probe_columns(files[i].c_str());
+	});
+
+	long long entries = 0;
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		loaded_probe_columns[files[i]] = dataset[i];
+		entries += dataset[i]->entries;
+	}
+	cout << "Loaded " << entries << " probes from " << files.size() << " file(s)\n";
+
+	loaded_probe_datasets[data_path] = dataset;
+	return loaded_probe_datasets[data_path];
+}
+
+//Closes every loaded file. They are loaded again when needed
+void release_probe_columns()
+{
+	for (auto& loaded : loaded_probe_columns)
+		close_probe_columns(loaded.second);
+	loaded_probe_columns  .clear();
+	loaded_probe_datasets .clear();
+	probe_dataset_last_use.clear();
+}
+
+//Loaded dataset used the longest time ago, or "" if none is loaded
+string least_recently_used_dataset()
+{
+	string    data_path;
+	long long last_use = 0;
+	for (auto& loaded : probe_dataset_last_use)
+		if (data_path.empty() || loaded.second < last_use)
+		{
+			data_path = loaded.first;
+			last_use  = loaded.second;
+		}
+	return data_path;
+}
+
+//Closes the files of a dataset that no other loaded dataset uses
+void release_probe_dataset(string data_path)
+{
+	auto found = loaded_probe_datasets.find(data_path);
+	probe_dataset_last_use.erase(data_path);
+	if (found == loaded_probe_datasets.end())
+		return;
+
+	ProbeDataset dataset = found->second;
+	loaded_probe_datasets.erase(found);
+
+	for (ProbeColumns* columns : dataset)
+	{
+		bool shared = false;
+		for (auto& loaded : loaded_probe_datasets)
+			shared = shared || find(loaded.second.begin(), loaded.second.end(), columns) != loaded.second.end();
+		if (shared)
+			continue;
+
+		for (auto loaded = loaded_probe_columns.begin(); loaded != loaded_probe_columns.end(); loaded++)
+			if (loaded->second == columns)
+			{
+				loaded_probe_columns.erase(loaded);
+				close_probe_columns(columns);
+				break;
+			}
+	}
+}
+#endif
@@ -0,0 +1,46 @@
+#ifndef PROBE_KERNEL_HEADER
+#define PROBE_KERNEL_HEADER
+//What the selections compiled by the interpreter use (probe_selection.h): the columns of a file and the selection loop
+//Macros declare it to the interpreter by themselves. Compiled executables declare it before the first selection
+#include <vector>
+
+struct ProbeColumns
+{
+	long long entries;
+	const float* InvariantMass;
+	const float* ProbeMuon_Pt;
+	const float* ProbeMuon_Eta;
+	const float* ProbeMuon_Phi;
+	const float* TagMuon_Pt;
+	const float* TagMuon_Eta;
+	const float* TagMuon_Phi;
+
+	//0 PassingProbeTrackingMuon, 1 PassingProbeStandAloneMuon, 2 PassingProbeGlobalMuon
+	const unsigned long long* passing[3];
+
+	//Memory behind the arrays, header included. Mapped from the columnar file or anonymous if read from the tree
+	void*  memory;
+	size_t memory_size;
+};
+
+//Passing bit of the probe i on one bit plane
+inline bool probe_passing(const unsigned long long* plane, unsigned i)
+{
+	return (plane[i >> 6] >> (i & 63)) & 1;
+}
+
+//Keeps the indices where pass(i) is true. Written without branches so it runs as a single vectorizable pass
+template <class Predicate>
+void select_probes(const vector<unsigned>& input, vector<unsigned>& output, Predicate pass)
+{
+	output.resize(input.size());
+	size_t nselected = 0;
+	for (size_t k = 0; k < input.size(); k++)
+	{
+		unsigned i = input[k];
+		output[nselected] = i;
+		nselected += pass(i) ? 1 : 0;
+	}
+	output.resize(nselected);
+}
+#endif
@@ -0,0 +1,213 @@
+#ifndef PROBE_SELECTION_HEADER
+#define PROBE_SELECTION_HEADER
+//Selection of probes without RooFormulaVar and without copying datasets
+//The columns are read once per file. Selections are compiled once to native code (cling JIT) and produce lists of indices
+#include "TInterpreter.h"
+#include "TMD5.h"
+
+#include <regex>
+
+#include "probe_columns.h"
+
+//Ranges of the RooRealVars used before, of the probe and of the tag muon. RooDataSet dropped every probe out of them
+const char* probe_ranges = "ProbeMuon_Pt >= 0. && ProbeMuon_Pt <= 40. && fabs(ProbeMuon_Eta) <= 2.4 && fabs(ProbeMuon_Phi) <= 3.14159265358979"
+	" && TagMuon_Pt >= 0. && TagMuon_Pt <= 40. && fabs(TagMuon_Eta) <= 2.4 && fabs(TagMuon_Phi) <= 3.14159265358979";
+
+//Bit plane of ProbeColumns::passing used by the muon id
+int passing_bit(string MuonId)
+{
+	if      (MuonId == "trackerMuon")    return 0;
+	else if (MuonId == "standaloneMuon") return 1;
+	else if (MuonId == "globalMuon")     return 2;
+
+	cerr << "Unknown muon id \"" << MuonId << "\"\n";
+	abort();
+}
+
+//Numbers of an expression rounded to float, as the columns: "ProbeMuon_Pt>=0.95" becomes "ProbeMuon_Pt>=(float)0.95"
+//Compared in double, a probe on an edge that float rounds down (0.95 is 0.9499999881) would move to the bin below
+string float_literals(string expression)
+{
+	string rounded;
+	size_t i = 0;
+	while (i < expression.size())
+	{
+		char c = expression[i];
+		bool starts_number = isdigit(c) || (c == '.' && i+1 < expression.size() && isdigit(expression[i+1]));
+		bool in_name       = i > 0 && (isalnum(expression[i-1]) || expression[i-1] == '_');
+		if (!starts_number || in_name)
+		{
+			rounded += c;
+			i++;
+			continue;
+		}
+
+		char* end;
+		strtod(expression.c_str() + i, &end);
+		size_t length = end - (expression.c_str() + i);
+		rounded += "(float)" + expression.substr(i, length);
+		i += length;
+	}
+	return rounded;
+}
+
+//Edges rounded to float, for the loops that bin the float columns without a compiled selection
+vector<double> float_edges(const vector<double>& edges)
+{
+	vector<double> rounded;
+	for (double edge : edges)
+		rounded.push_back((float)edge);
+	return rounded;
+}
+
+//Selection compiled from a string like "ProbeMuon_Pt>=2.0 && abs(ProbeMuon_Eta)< 1.2"
+typedef void (*ProbeSelectionFunction)(const ProbeColumns&, const vector<unsigned>&, vector<unsigned>&);
+map<string, ProbeSelectionFunction> compiled_selections;
+
+ProbeSelectionFunction compile_selection(string expression)
+{
+	auto found = compiled_selections.find(expression);
+	if (found != compiled_selections.end())
+		return found->second;
+
+	TMD5 md5;
+	md5.Update((const UChar_t*)expression.data(), expression.size());
+	md5.Final();
+	string function_name = string("probe_selection_") + md5.AsString();
+
+	//Every column name becomes an access to the array on the current index, compared with the numbers in float
+	string body = regex_replace(float_literals(expression), regex("\\b(InvariantMass|ProbeMuon_Pt|ProbeMuon_Eta|ProbeMuon_Phi|TagMuon_Pt|TagMuon_Eta|TagMuon_Phi)\\b"), "$1[i]");
+	body = regex_replace(body, regex("\\bPassingProbeTrackingMuon\\b"),   "probe_passing(c.passing[0], i)");
+	body = regex_replace(body, regex("\\bPassingProbeStandAloneMuon\\b"), "probe_passing(c.passing[1], i)");
+	body = regex_replace(body, regex("\\bPassingProbeGlobalMuon\\b"),     "probe_passing(c.passing[2], i)");
+
+#ifndef __CLING__
+	//Compiled executables: the interpreter does not know the columns yet (EFFICIENCY_SOURCE_DIR comes from CMakeLists.txt)
+	static bool kernel_declared = gInterpreter->Declare("#include \"" EFFICIENCY_SOURCE_DIR "/src/probe_kernel.h\"");
+	if (!kernel_declared)
+	{
+		cerr << "Could not declare src/probe_kernel.h to the interpreter\n";
+		abort();
+	}
+#endif
+
+	string code;
+	code += "void " + function_name + "(const ProbeColumns& c, const vector<unsigned>& input, vector<unsigned>& output)\n";
+	code += "{\n";
+	code += "	const float* InvariantMass = c.InvariantMass;\n";
+	code += "	const float* ProbeMuon_Pt  = c.ProbeMuon_Pt;\n";
+	code += "	const float* ProbeMuon_Eta = c.ProbeMuon_Eta;\n";
+	code += "	const float* ProbeMuon_Phi = c.ProbeMuon_Phi;\n";
+	code += "	const float* TagMuon_Pt    = c.TagMuon_Pt;\n";
+	code += "	const float* TagMuon_Eta   = c.TagMuon_Eta;\n";
+	code += "	const float* TagMuon_Phi   = c.TagMuon_Phi;\n";
+	code += "	select_probes(input, output, [&](unsigned i) { return (bool)(" + body + "); });\n";
+	code += "}\n";
+
+	if (!gInterpreter->Declare(code.c_str()))
+	{
+		cerr << "Could not compile the selection \"" << expression << "\"\n";
+		abort();
+	}
+
+	ProbeSelectionFunction function = (ProbeSelectionFunction)gInterpreter->Calc(("(long)&" + function_name).c_str());
+	compiled_selections[expression] = function;
+	return function;
+}
+
+//Indices of the selected probes on each file of a dataset
+typedef vector<vector<unsigned>> DatasetSelection;
+
+//Probes passing tag cut and ranges, by data path and tag cut
+map<string, DatasetSelection> tag_selected_probes;
+
+//Last bin selected. The systematic variations select the same bin several times in a row
+string           last_bin_selection_key;
+DatasetSelection last_bin_selection;
+
+//Indices of the probes on the bin, for each file. Files are selected in parallel. The lists are valid until the next call
+const DatasetSelection& select_bin_probes(const char* data_path, string condition)
+{
+	const ProbeDataset& dataset = load_probe_dataset(data_path);
+
+	string tag_key = string(data_path) + "\n" + tag_cut;
+	if (tag_selected_probes.find(tag_key) == tag_selected_probes.end())
+	{
+		ProbeSelectionFunction selection = compile_selection(string("(") + tag_cut + ") && (" + probe_ranges + ")");
+		DatasetSelection& selected = tag_selected_probes[tag_key];
+		selected.resize(dataset.size());
+
+		for_each_file(dataset.size(), [&](unsigned f)
+		{
+			vector<unsigned> all_probes(dataset[f]->entries);
+			for (long long i = 0; i < dataset[f]->entries; i++)
+				all_probes[i] = i;
+
+			selection(*dataset[f], all_probes, selected[f]);
+		});
+	}
+
+	string bin_key = tag_key + "\n" + condition;
+	if (bin_key != last_bin_selection_key)
+	{
+		ProbeSelectionFunction selection = compile_selection(condition);
+		const DatasetSelection& tag_selected = tag_selected_probes[tag_key];
+		last_bin_selection.resize(dataset.size());
+
+		for_each_file(dataset.size(), [&](unsigned f)
+		{
+			selection(*dataset[f], tag_selected[f], last_bin_selection[f]);
+		});
+		last_bin_selection_key = bin_key;
+	}
+
+	return last_bin_selection;
+}
+
+//Forgets the probes selected so far. Needed before the files they point to are closed
+void release_probe_selections()
+{
+	tag_selected_probes.clear();
+	last_bin_selection.clear();
+	last_bin_selection_key = "";
+}
+
+//Forgets the probes selected on one data path, before its files are closed
+void release_dataset_selections(string data_path)
+{
+	string prefix = data_path + "\n";
+	for (auto selected = tag_selected_probes.begin(); selected != tag_selected_probes.end();)
+	{
+		if (selected->first.compare(0, prefix.size(), prefix) == 0)
+			selected = tag_selected_probes.erase(selected);
+		else
+			selected++;
+	}
+
+	if (last_bin_selection_key.compare(0, prefix.size(), prefix) == 0)
+	{
+		last_bin_selection.clear();
+		last_bin_selection_key = "";
+	}
+}
+
+//Fills the invariant mass of ALL and PASSING probes of one file. Masses out of the histogram range are not used on the fit
+void fill_file_mass_histograms(const ProbeColumns& columns, const vector<unsigned>& probes, int bit, TH1* hist_all, TH1* hist_pass)
+{
+	const float*              mass    = columns.InvariantMass;
+	const unsigned long long* passing = columns.passing[bit];
+	for (unsigned i : probes)
+	{
+		hist_all->Fill(mass[i]);
+		if (probe_passing(passing, i))
+			hist_pass->Fill(mass[i]);
+	}
+}
+
+//Same for every file of a dataset
+void fill_mass_histograms(const ProbeDataset& dataset, const DatasetSelection& probes, int bit, TH1* hist_all, TH1* hist_pass)
+{
+	for (size_t f = 0; f < dataset.size(); f++)
+		fill_file_mass_histograms(*dataset[f], probes[f], bit, hist_all, hist_pass);
+}
+#endif
@@ -0,0 +1,71 @@
+#ifndef RESULTS_RECORDS_HEADER
+#define RESULTS_RECORDS_HEADER
+//Records of the efficiencies of a run for the results store (results_store.h), with the settings of the fits
+//Include it after the DoFit headers
+#include "results_store.h"
+
+//Record of a bin with the settings of this run
+EfficiencyRecord make_record(string MuonId, string quantity, string variation, string model, int bin, double low, double high,
+	const YieldsNErrs& yields_n_errs, FitInfo fit_info)
+{
+	EfficiencyRecord record;
+	record.run         = 0;
+	record.dataset     = output_folder_name;
+	record.data_file   = data_file_path;
+	record.MuonId      = MuonId;
+	record.quantity    = quantity;
+	record.variation   = variation;
+	record.model       = model;
+	record.bin         = bin;
+	record.low         = low;
+	record.high        = high;
+	record.ylow        = 0.;
+	record.yhigh       = 0.;
+	record.yield_all   = yields_n_errs[0];
+	record.yield_pass  = yields_n_errs[1];
+	record.err_all     = yields_n_errs[2];
+	record.err_pass    = yields_n_errs[3];
+	record.fit_status  = fit_info.status;
+	record.fit_seconds = fit_info.seconds;
+	return record;
+}
+
+//Records of a 1D efficiency made by get_efficiency
+vector<EfficiencyRecord> efficiency_records(TEfficiency* pEff, const vector<double>& bins, string quantity, string MuonId, string variation, string model,
+	const vector<YieldsNErrs>& yields_n_errs, const vector<FitInfo>& fit_info)
+{
+	vector<EfficiencyRecord> records;
+	for (int i = 0; i < (int)bins.size() - 1; i++)
+	{
+		EfficiencyRecord record = make_record(MuonId, quantity, variation, model, i, bins[i], bins[i+1], yields_n_errs[i], fit_info[i]);
+		record.efficiency = pEff->GetEfficiency(i+1);
+		record.err_low    = pEff->GetEfficiencyErrorLow(i+1);
+		record.err_high   = pEff->GetEfficiencyErrorUp(i+1);
+		records.push_back(record);
+	}
+	return records;
+}
+
+//Records of a 2D efficiency made by get_efficiency_TH2D. Bin (i, j) of the yields is at i*nbinsy + j
+vector<EfficiencyRecord> efficiency_records_2d(TH2D* heff, const vector<double>& xbins, const vector<double>& ybins, string xquantity, string yquantity,
+	string MuonId, string variation, string model, const vector<YieldsNErrs>& yields_n_errs, const vector<FitInfo>& fit_info)
+{
+	vector<EfficiencyRecord> records;
+	int nbinsx = xbins.size() - 1;
+	int nbinsy = ybins.size() - 1;
+	for (int i = 0; i < nbinsx; i++)
+		for (int j = 0; j < nbinsy; j++)
+		{
+			int bin = i*nbinsy + j;
+			EfficiencyRecord record = make_record(MuonId, yquantity + "_" + xquantity, variation, model, bin, xbins[i], xbins[i+1],
+				yields_n_errs[bin], fit_info[bin]);
+			record.ylow       = ybins[j];
+			record.yhigh      = ybins[j+1];
+			record.efficiency = heff->GetBinContent(i+1, j+1);
+			record.err_low    = heff->GetBinError(i+1, j+1);
+			record.err_high   = heff->GetBinError(i+1, j+1);
+			records.push_back(record);
+		}
+	return records;
+}
+#endif
@@ -0,0 +1,257 @@
+#ifndef RESULTS_STORE_HEADER
+#define RESULTS_STORE_HEADER
+//Efficiencies of every run in one file, so comparisons between runs do not need to open the output file of each one
+//The tree "results" has one entry by bin of every efficiency (nominal, variations, final) written by a run
+//Runs append under a lock (<store>.lock), so macros running at the same time can write on the same store
+//read_results loads the store once with an index by dataset, Muon Id, quantity and variation. find_results, results_graph and results_map query it
+//The records of a run are made by results_records.h
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#include <set>
+
+//File of the store. Empty does not record anything
+string results_store_path = "results/efficiency_results.root";
+
+struct EfficiencyRecord
+{
+	int    run;          //Number of the run that wrote it, given by the store
+	string time;         //When it was written
+	string dataset;      //output_folder_name
+	string data_file;
+	string MuonId;
+	string quantity;     //Like "Pt", or "Eta_Pt" on 2D (yquantity_xquantity)
+	string variation;    //"Nominal", a systematic variation, "Systematic" or "Final"
+	string model;        //Key of fit_models, empty if it is a combination of fits
+	int    bin;
+	double low;          //Edges of the bin
+	double high;
+	double ylow;         //Edges of the bin of yquantity on 2D, 0 on 1D
+	double yhigh;
+	double yield_all;
+	double yield_pass;
+	double err_all;
+	double err_pass;
+	double efficiency;
+	double err_low;
+	double err_high;
+	int    fit_status;   //-1 if it was not fitted by this run
+	double fit_seconds;
+};
+
+//Branches of the tree, in the same order for writing and reading
+vector<pair<const char*, string EfficiencyRecord::*>> results_string_branches = {
+	{"time", &EfficiencyRecord::time}, {"dataset", &EfficiencyRecord::dataset}, {"data_file", &EfficiencyRecord::data_file},
+	{"MuonId", &EfficiencyRecord::MuonId}, {"quantity", &EfficiencyRecord::quantity}, {"variation", &EfficiencyRecord::variation},
+	{"model", &EfficiencyRecord::model}
+};
+vector<pair<const char*, int EfficiencyRecord::*>> results_int_branches = {
+	{"run", &EfficiencyRecord::run}, {"bin", &EfficiencyRecord::bin}, {"fit_status", &EfficiencyRecord::fit_status}
+};
+vector<pair<const char*, double EfficiencyRecord::*>> results_double_branches = {
+	{"low", &EfficiencyRecord::low}, {"high", &EfficiencyRecord::high}, {"ylow", &EfficiencyRecord::ylow}, {"yhigh", &EfficiencyRecord::yhigh},
+	{"yield_all", &EfficiencyRecord::yield_all}, {"yield_pass", &EfficiencyRecord::yield_pass},
+	{"err_all", &EfficiencyRecord::err_all}, {"err_pass", &EfficiencyRecord::err_pass},
+	{"efficiency", &EfficiencyRecord::efficiency}, {"err_low", &EfficiencyRecord::err_low}, {"err_high", &EfficiencyRecord::err_high},
+	{"fit_seconds", &EfficiencyRecord::fit_seconds}
+};
+
+//Connects the branches of an existing tree to record. string_addresses has to live while the tree is used
+void connect_results_branches(TTree* tree, EfficiencyRecord& record, vector<string*>& string_addresses)
+{
+	string_addresses.clear();
+	for (auto& branch : results_string_branches)
+		string_addresses.push_back(&(record.*branch.second));
+	for (size_t k = 0; k < results_string_branches.size(); k++)
+		tree->SetBranchAddress(results_string_branches[k].first, &string_addresses[k]);
+	for (auto& branch : results_int_branches)
+		tree->SetBranchAddress(branch.first, &(record.*branch.second));
+	for (auto& branch : results_double_branches)
+		tree->SetBranchAddress(branch.first, &(record.*branch.second));
+}
+
+TTree* create_results_tree(EfficiencyRecord& record)
+{
+	TTree* tree = new TTree("results", "Efficiency results");
+	for (auto& branch : results_string_branches)
+		tree->Branch(branch.first, &(record.*branch.second));
+	for (auto& branch : results_int_branches)
+		tree->Branch(branch.first, &(record.*branch.second), (string(branch.first) + "/I").c_str());
+	for (auto& branch : results_double_branches)
+		tree->Branch(branch.first, &(record.*branch.second), (string(branch.first) + "/D").c_str());
+	return tree;
+}
+
+//Adds the records of a run, all with the same new run number, and returns it (-1 if the store is off)
+int append_results(const vector<EfficiencyRecord>& records, string path = results_store_path)
+{
+	if (path == "" || records.empty())
+		return -1;
+
+	//Only one writer at a time. The lock is released by the system if the process dies
+	int lock = open((path + ".lock").c_str(), O_CREAT | O_RDWR, 0644);
+	if (lock < 0 || flock(lock, LOCK_EX) != 0)
+	{
+		cerr << "Could not lock \"" << path << "\" results store\n";
+		abort();
+	}
+
+	TDirectory* previous_dir = gDirectory;
+	TFile* store = TFile::Open(path.c_str(), "UPDATE");
+	if (store == NULL || store->IsZombie())
+	{
+		cerr << "Could not open \"" << path << "\" results store\n";
+		abort();
+	}
+
+	EfficiencyRecord record;
+	vector<string*>  string_addresses;
+	TTree* tree = (TTree*)store->Get("results");
+	int run = 1;
+	if (tree == NULL)
+		tree = create_results_tree(record);
+	else
+	{
+		connect_results_branches(tree, record, string_addresses);
+		run = (int)tree->GetMaximum("run") + 1;
+	}
+
+	string time = TDatime().AsSQLString();
+	for (const EfficiencyRecord& new_record : records)
+	{
+		record      = new_record;
+		record.run  = run;
+		record.time = time;
+		tree->Fill();
+	}
+	tree->Write("", TObject::kOverwrite);
+
+	store->Close();
+	delete store;
+	previous_dir->cd();
+
+	flock(lock, LOCK_UN);
+	close(lock);
+
+	cout << "Results store: run " << run << " with " << records.size() << " bins on \"" << path << "\"\n";
+	return run;
+}
+
+struct ResultsStore
+{
+	vector<EfficiencyRecord> records;
+	map<string, vector<int>> index;    //Records of each results_key, in the order they were written
+};
+
+string results_key(string dataset, string MuonId, string quantity, string variation)
+{
+	return dataset + " | " + MuonId + " | " + quantity + " | " + variation;
+}
+
+//Loads every record of the store. Returns an empty store if it does not exist
+ResultsStore read_results(string path = results_store_path)
+{
+	ResultsStore store;
+	TDirectory* previous_dir = gDirectory;
+	TFile* file = (path != "" && !gSystem->AccessPathName(path.c_str())) ? TFile::Open(path.c_str()) : NULL;
+	TTree* tree = (file != NULL) ? (TTree*)file->Get("results") : NULL;
+	if (tree == NULL)
+	{
+		delete file;
+		previous_dir->cd();
+		return store;
+	}
+
+	EfficiencyRecord record;
+	vector<string*>  string_addresses;
+	connect_results_branches(tree, record, string_addresses);
+
+	Long64_t nentries = tree->GetEntries();
+	store.records.reserve(nentries);
+	for (Long64_t entry = 0; entry < nentries; entry++)
+	{
+		tree->GetEntry(entry);
+		store.index[results_key(record.dataset, record.MuonId, record.quantity, record.variation)].push_back(store.records.size());
+		store.records.push_back(record);
+	}
+
+	file->Close();
+	delete file;
+	previous_dir->cd();
+	return store;
+}
+
+//Runs that have the efficiency, in the order they were written
+vector<int> result_runs(const ResultsStore& store, string dataset, string MuonId, string quantity, string variation = "Nominal")
+{
+	vector<int> runs;
+	auto found = store.index.find(results_key(dataset, MuonId, quantity, variation));
+	if (found != store.index.end())
+		for (int row : found->second)
+			if (runs.empty() || runs.back() != store.records[row].run)
+				runs.push_back(store.records[row].run);
+	return runs;
+}
+
+//Bins of the efficiency written by a run. run = 0 takes the last run that has it
+vector<EfficiencyRecord> find_results(const ResultsStore& store, string dataset, string MuonId, string quantity, string variation = "Nominal", int run = 0)
+{
+	vector<EfficiencyRecord> records;
+	auto found = store.index.find(results_key(dataset, MuonId, quantity, variation));
+	if (found == store.index.end())
+		return records;
+
+	if (run == 0)
+		run = store.records[found->second.back()].run;
+	for (int row : found->second)
+		if (store.records[row].run == run)
+			records.push_back(store.records[row]);
+	return records;
+}
+
+//Efficiency of 1D records as a graph, with the bin widths as x errors
+TGraphAsymmErrors* results_graph(const vector<EfficiencyRecord>& records, string name)
+{
+	TGraphAsymmErrors* graph = new TGraphAsymmErrors(records.size());
+	graph->SetName(name.c_str());
+	for (size_t i = 0; i < records.size(); i++)
+	{
+		const EfficiencyRecord& record = records[i];
+		double center = 0.5*(record.low + record.high);
+		double width  = 0.5*(record.high - record.low);
+		graph->SetPoint(i, center, record.efficiency);
+		graph->SetPointError(i, width, width, record.err_low, record.err_high);
+	}
+	if (!records.empty())
+		graph->SetTitle(("Efficiency for " + records[0].MuonId + " " + records[0].quantity + " (" + records[0].dataset + ", run " + to_string(records[0].run) + ")").c_str());
+	return graph;
+}
+
+//Efficiency of 2D records as a map, with the bins of the records and the largest of their errors
+TH2D* results_map(const vector<EfficiencyRecord>& records, string name)
+{
+	set<double> xedges, yedges;
+	for (const EfficiencyRecord& record : records)
+	{
+		xedges.insert(record.low);
+		xedges.insert(record.high);
+		yedges.insert(record.ylow);
+		yedges.insert(record.yhigh);
+	}
+	vector<double> xbins(xedges.begin(), xedges.end());
+	vector<double> ybins(yedges.begin(), yedges.end());
+	if (xbins.size() < 2 || ybins.size() < 2)
+		return NULL;
+
+	TH2D* efficiency_map = new TH2D(name.c_str(), "", xbins.size() - 1, xbins.data(), ybins.size() - 1, ybins.data());
+	efficiency_map->SetDirectory(0);
+	for (const EfficiencyRecord& record : records)
+	{
+		int bin = efficiency_map->FindBin(0.5*(record.low + record.high), 0.5*(record.ylow + record.yhigh));
+		efficiency_map->SetBinContent(bin, record.efficiency);
+		efficiency_map->SetBinError  (bin, max(record.err_low, record.err_high));
+	}
+	efficiency_map->SetTitle(("Efficiency for " + records[0].MuonId + " (" + records[0].dataset + ", run " + to_string(records[0].run) + ")").c_str());
+	return efficiency_map;
+}
+#endif
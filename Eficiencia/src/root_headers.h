@@ -0,0 +1,66 @@
+#ifndef ROOT_HEADERS_HEADER
+#define ROOT_HEADERS_HEADER
+//Headers that cling loads by itself when the macros are interpreted
+//The macros include this first, so they are also translation units of the compiled executables (CMakeLists.txt)
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Compression.h"
+#include "RVersion.h"
+#include "TCanvas.h"
+#include "TDirectory.h"
+#include "TEfficiency.h"
+#include "TFile.h"
+#include "TGraphAsymmErrors.h"
+#include "TH1D.h"
+#include "TH2D.h"
+#include "TInterpreter.h"
+#include "TKey.h"
+#include "TLatex.h"
+#include "TLegend.h"
+#include "TMD5.h"
+#include "TObjString.h"
+#include "TROOT.h"
+#include "TRandom3.h"
+#include "TStopwatch.h"
+#include "TStyle.h"
+#include "TSystem.h"
+#include "TTree.h"
+#include "TVectorD.h"
+#include "TVirtualPad.h"
+
+#include "RooAddPdf.h"
+#include "RooArgList.h"
+#include "RooArgSet.h"
+#include "RooCBShape.h"
+#include "RooCategory.h"
+#include "RooCmdArg.h"
+#include "RooDataHist.h"
+#include "RooDataSet.h"
+#include "RooExponential.h"
+#include "RooFitResult.h"
+#include "RooFormulaVar.h"
+#include "RooGaussian.h"
+#include "RooGlobalFunc.h"
+#include "RooLinkedList.h"
+#include "RooMinimizer.h"
+#include "RooMsgService.h"
+#include "RooPlot.h"
+#include "RooRealVar.h"
+#include "RooSimultaneous.h"
+
+using namespace std;
+#endif
@@ -0,0 +1,288 @@
+#ifndef TOY_EFFICIENCY_HEADER
+#define TOY_EFFICIENCY_HEADER
+//Uncertainty of the efficiency of a bin from datasets resampled and fitted again with the fast likelihood (fast_binned_fit.h)
+//"bootstrap" resamples the counts of the data, "toys" generates them from the fitted model
+//PASSING and FAILING counts are generated independently and ALL = PASSING + FAILING, so PASSING stays a subset of ALL
+//and the spread of the efficiency includes the correlation of both yields, that the errors of get_efficiency ignore
+//Toys run in parallel on the threads of data_pool. Each task copies the likelihood with its buffers once and reuses it for all its toys
+#include "TRandom3.h"
+
+//Toys fitted after every fit of doFit. 0 does not make them
+int toys_per_bin = 0;
+
+//False on fits that only give yields to others, like the systematic variations, so toys are only made for the nominal fit
+bool toys_on_this_fit = true;
+
+//"bootstrap" or "toys"
+string toy_mode = "bootstrap";
+
+//Seed of the first task. Every task has its own seed, so the toys do not depend on the number of threads
+unsigned toy_seed = 4357;
+
+//Toys of each task
+int toys_per_task = 50;
+
+//Probability inside the interval of the efficiency
+double toy_confidence_level = 0.6827;
+
+struct ToyStudy
+{
+	string condition;
+	double efficiency;            //Of the fit of the data
+	double error;                 //Its error, with the covariance of both yields
+	vector<double> efficiencies;  //Of every toy that converged
+	vector<double> pulls;         //(toy - generated efficiency)/error of the toy
+	double low;                   //Central interval of the efficiencies of the toys
+	double high;
+	int    nfailed;               //Toys that did not converge
+	string problem;               //Why no toy was made, empty if they were
+};
+
+//Study of the last fit of doFit
+ToyStudy last_toy_study;
+
+//Efficiency n_signal_total_pass/n_signal_total and its error with the covariance of both
+void toy_efficiency_and_error(const FastFitResult& result, double& efficiency, double& error)
+{
+	double n_all  = result.values[kNSignal];
+	double n_pass = result.values[kNSignalPass];
+	efficiency = n_pass/n_all;
+
+	double relative2 = pow(result.errors[kNSignalPass]/n_pass, 2) + pow(result.errors[kNSignal]/n_all, 2) - 2.*result.cov_signal/(n_pass*n_all);
+	error = efficiency*sqrt(max(relative2, 0.));
+}
+
+//Value below which a fraction q of the sorted values is
+double toy_quantile(const vector<double>& sorted, double q)
+{
+	if (sorted.empty())
+		return 0.;
+
+	double position = q*(sorted.size() - 1);
+	int    below    = (int)position;
+	if (below + 1 >= (int)sorted.size())
+		return sorted.back();
+	return sorted[below] + (position - below)*(sorted[below+1] - sorted[below]);
+}
+
+//Mean and width of the pulls of the toys
+void pull_mean_and_width(const vector<double>& pulls, double& mean, double& width)
+{
+	mean  = 0.;
+	width = 0.;
+	for (double pull : pulls)
+		mean  += pull/pulls.size();
+	for (double pull : pulls)
+		width += pow(pull - mean, 2)/pulls.size();
+	width = sqrt(width);
+}
+
+//Fits toys_per_bin toys of the model fitted on combData. The parameters of the fit must be in the RooRealVars of the model
+ToyStudy toy_study(RooSimultaneous& simPdf, RooDataHist& combData, string model_name, string condition)
+{
+	if (!fast_backend_supports(model_name))
+	{
+		cerr << "Toys need the fast likelihood, that does not have model \"" << model_name << "\"\n";
+		abort();
+	}
+	if (toy_mode != "bootstrap" && toy_mode != "toys")
+	{
+		cerr << "Unknown toy_mode \"" << toy_mode << "\". Use \"bootstrap\" or \"toys\"\n";
+		abort();
+	}
+
+	RooRealVar*   vars[kNFastFitParameters];
+	FastBinnedNLL data_nll = make_fast_nll(simPdf, combData, model_name, vars);
+	int nbins = data_nll.nbins;
+
+	//Fit of the data again with the fast likelihood, starting on its minimum, for the covariance of the yields
+	double start[kNFastFitParameters], step[kNFastFitParameters], lower[kNFastFitParameters], upper[kNFastFitParameters];
+	for (int i = 0; i < kNFastFitParameters; i++)
+	{
+		start[i] = vars[i]->getVal();
+		lower[i] = vars[i]->getMin();
+		upper[i] = vars[i]->getMax();
+		step[i]  = (vars[i]->getError() > 0.) ? vars[i]->getError() : 0.1*(upper[i] - lower[i]);
+	}
+	FastFitResult data_result = fast_binned_fit(data_nll, start, step, lower, upper);
+
+	ToyStudy study;
+	study.condition = condition;
+	study.nfailed   = 0;
+	toy_efficiency_and_error(data_result, study.efficiency, study.error);
+
+	//Mean PASSING and FAILING counts of every mass bin
+	vector<double> mean_pass(nbins), mean_fail(nbins);
+	string         inconsistent_bins;
+	if (toy_mode == "bootstrap")
+		for (int i = 0; i < nbins; i++)
+		{
+			mean_pass[i] = data_nll.counts_pass[i];
+			mean_fail[i] = max(data_nll.counts_all[i] - data_nll.counts_pass[i], 0.);
+		}
+	else
+	{
+		//Evaluating the likelihood leaves the signal and background fractions of every bin in its buffers
+		const double* par = data_result.values.data();
+		data_nll(par);
+		for (int i = 0; i < nbins; i++)
+		{
+			double expected_all  = par[kNSignal]    *data_nll.sig[i] + par[kNBack]    *data_nll.bkg[i];
+			double expected_pass = par[kNSignalPass]*data_nll.sig[i] + par[kNBackPass]*data_nll.bkg[i];
+			mean_pass[i] = expected_pass;
+			mean_fail[i] = expected_all - expected_pass;
+
+			//More PASSING than ALL is only rounding when it is this small. Otherwise FAILING would be generated from a biased mean
+			if (mean_fail[i] < -1e-9*expected_all)
+				inconsistent_bins += " " + to_string(i);
+			mean_fail[i] = max(mean_fail[i], 0.);
+		}
+	}
+
+	if (inconsistent_bins != "")
+	{
+		study.problem = "fit expects more PASSING than ALL on mass bins" + inconsistent_bins;
+		study.low     = study.efficiency;
+		study.high    = study.efficiency;
+		study.nfailed = toys_per_bin;
+		cout << "Toys not made for \"" << condition << "\": " << study.problem << " (n_back_pass and n_back are not consistent)\n";
+		return study;
+	}
+
+	//Results by toy, written by the tasks on their own slots
+	vector<double> efficiencies(toys_per_bin), pulls(toys_per_bin);
+	vector<char>   converged(toys_per_bin, 0);
+
+	int ntasks = (toys_per_bin + toys_per_task - 1)/toys_per_task;
+	TStopwatch watch;
+	for_each_task(ntasks, [&](unsigned task)
+	{
+		FastBinnedNLL  nll = data_nll;
+		TRandom3       random(toy_seed + task);
+		vector<double> counts_all(nbins), counts_pass(nbins);
+		double toy_start[kNFastFitParameters], toy_upper[kNFastFitParameters];
+
+		int last_toy = min((int)(task + 1)*toys_per_task, toys_per_bin);
+		for (int toy = task*toys_per_task; toy < last_toy; toy++)
+		{
+			double sum_all = 0., sum_pass = 0.;
+			for (int i = 0; i < nbins; i++)
+			{
+				counts_pass[i] = random.Poisson(mean_pass[i]);
+				counts_all [i] = counts_pass[i] + random.Poisson(mean_fail[i]);
+				sum_all  += counts_all [i];
+				sum_pass += counts_pass[i];
+			}
+			nll.set_data(counts_all.data(), counts_pass.data());
+
+			//Limits of the yields as in doFit, starting from the fit of the data
+			for (int i = 0; i < kNFastFitParameters; i++)
+				toy_upper[i] = upper[i];
+			toy_upper[kNSignal]     = toy_upper[kNBack]     = sum_all;
+			toy_upper[kNSignalPass] = toy_upper[kNBackPass] = sum_pass;
+			for (int i = 0; i < kNFastFitParameters; i++)
+				toy_start[i] = min(max(data_result.values[i], lower[i]), 0.99*toy_upper[i]);
+
+			FastFitResult result = fast_binned_fit(nll, toy_start, step, lower, toy_upper);
+			if (result.status != 0 || sum_pass <= 0.)
+				continue;
+
+			double efficiency, error;
+			toy_efficiency_and_error(result, efficiency, error);
+			efficiencies[toy] = efficiency;
+			pulls[toy]        = (error > 0.) ? (efficiency - study.efficiency)/error : 0.;
+			converged[toy]    = 1;
+		}
+	});
+
+	for (int toy = 0; toy < toys_per_bin; toy++)
+		if (converged[toy])
+		{
+			study.efficiencies.push_back(efficiencies[toy]);
+			study.pulls       .push_back(pulls[toy]);
+		}
+	study.nfailed = toys_per_bin - study.efficiencies.size();
+
+	vector<double> sorted = study.efficiencies;
+	sort(sorted.begin(), sorted.end());
+	study.low  = toy_quantile(sorted, 0.5*(1. - toy_confidence_level));
+	study.high = toy_quantile(sorted, 0.5*(1. + toy_confidence_level));
+
+	double pull_mean, pull_width;
+	pull_mean_and_width(study.pulls, pull_mean, pull_width);
+
+	printf("Toys (%s): %d in %.2fs, %d failed. Efficiency %.4f +/- %.4f, interval [%.4f, %.4f], pulls %.2f +/- %.2f\n",
+		toy_mode.c_str(), toys_per_bin, watch.RealTime(), study.nfailed, study.efficiency, study.error, study.low, study.high, pull_mean, pull_width);
+	return study;
+}
+
+//Writes on the current directory the efficiency with the intervals of the toys, the pulls by bin
+//and the distributions of the efficiency and pulls of every bin. Bins without toys have the error of their fit
+void write_toy_studies(const vector<ToyStudy>& studies, const double* bins, int nbins, string quantity, string MuonId)
+{
+	string name = MuonId + "_" + quantity;
+
+	TGraphAsymmErrors* graph = new TGraphAsymmErrors(nbins);
+	graph->SetName ((name + "_Toys_Efficiency").c_str());
+	graph->SetTitle(("Efficiency for " + MuonId + " " + quantity + " (" + toy_mode + ");" + quantity + ";Efficiency").c_str());
+
+	TH1D* pull_mean  = new TH1D((name + "_Pull_Mean") .c_str(), ("Mean of the pulls;"  + quantity).c_str(), nbins, bins);
+	TH1D* pull_width = new TH1D((name + "_Pull_Width").c_str(), ("Width of the pulls;" + quantity).c_str(), nbins, bins);
+
+	for (int i = 0; i < nbins && i < (int)studies.size(); i++)
+	{
+		const ToyStudy& study = studies[i];
+		double center = 0.5*(bins[i] + bins[i+1]);
+		double width  = 0.5*(bins[i+1] - bins[i]);
+		graph->SetPoint(i, center, study.efficiency);
+		if (study.problem == "")
+			graph->SetPointError(i, width, width, max(study.efficiency - study.low, 0.), max(study.high - study.efficiency, 0.));
+		else
+			graph->SetPointError(i, width, width, study.error, study.error);
+
+		string bin_name = name + "_bin" + to_string(i);
+		TH1D* efficiencies = new TH1D((bin_name + "_Toys_Efficiency").c_str(), (study.condition + ";Efficiency").c_str(), 100,
+			study.efficiency - 5.*study.error, study.efficiency + 5.*study.error);
+		TH1D* pulls = new TH1D((bin_name + "_Toys_Pull").c_str(), (study.condition + ";Pull").c_str(), 100, -5., 5.);
+		for (size_t toy = 0; toy < study.efficiencies.size(); toy++)
+		{
+			efficiencies->Fill(study.efficiencies[toy]);
+			pulls       ->Fill(study.pulls[toy]);
+		}
+
+		pull_mean ->SetBinContent(i+1, pulls->GetMean());
+		pull_mean ->SetBinError  (i+1, pulls->GetMeanError());
+		pull_width->SetBinContent(i+1, pulls->GetStdDev());
+		pull_width->SetBinError  (i+1, pulls->GetStdDevError());
+	}
+
+	graph->Write();
+}
+
+//Writes on the current directory the 2D efficiency (bin (i, j) is study i*nbinsy + j) with half the interval of the toys as error
+//and the mean and width of the pulls of every bin. Histograms stay on the directory, written with it
+void write_toy_studies_2d(const vector<ToyStudy>& studies, const double* xbins, int nbinsx, const double* ybins, int nbinsy,
+	string xquantity, string yquantity, string MuonId)
+{
+	string name = MuonId + "_" + yquantity + "_" + xquantity;
+	string axes = ";" + xquantity + ";" + yquantity;
+
+	TH2D* efficiency = new TH2D((name + "_Toys_Efficiency").c_str(), ("Efficiency for " + MuonId + " (" + toy_mode + ")" + axes).c_str(),
+		nbinsx, xbins, nbinsy, ybins);
+	TH2D* pull_mean  = new TH2D((name + "_Pull_Mean") .c_str(), ("Mean of the pulls"  + axes).c_str(), nbinsx, xbins, nbinsy, ybins);
+	TH2D* pull_width = new TH2D((name + "_Pull_Width").c_str(), ("Width of the pulls" + axes).c_str(), nbinsx, xbins, nbinsy, ybins);
+
+	for (int i = 0; i < nbinsx; i++)
+		for (int j = 0; j < nbinsy && i*nbinsy + j < (int)studies.size(); j++)
+		{
+			const ToyStudy& study = studies[i*nbinsy + j];
+			efficiency->SetBinContent(i+1, j+1, study.efficiency);
+			efficiency->SetBinError  (i+1, j+1, (study.problem == "") ? 0.5*(study.high - study.low) : study.error);
+
+			double mean, width;
+			pull_mean_and_width(study.pulls, mean, width);
+			pull_mean ->SetBinContent(i+1, j+1, mean);
+			pull_width->SetBinContent(i+1, j+1, width);
+		}
+}
+#endif
@@ -0,0 +1,67 @@
+#ifndef TREE_OUTPUT_SETTINGS_HEADER
+#define TREE_OUTPUT_SETTINGS_HEADER
+//How the simplified tag and probe trees are written
+#include "Compression.h"
+#include "TROOT.h"
+
+//"lz4" reads fastest, "zstd" and "lzma" make smaller files, "zlib" is the ROOT default
+//Empty writes new baskets with the ROOT default compression of the output file ("copy" mode)
+//On "fast" mode empty copies the compressed baskets of the source as they are, which is the only way they are not compressed again
+string compression_algorithm = "";
+int    compression_level     = 4;
+
+//Bytes of each basket and entries of each cluster (negative for bytes, like TTree::SetAutoFlush)
+int       basket_size = 256000;
+long long auto_flush  = -30000000;
+
+//Threads compressing the baskets while writing. 0 uses every core, 1 writes from a single thread
+int write_threads = 0;
+
+//Value of the compression settings for TFile, or -1 for the ROOT default
+int output_compression_settings()
+{
+	ROOT::RCompressionSetting::EAlgorithm::EValues algorithm;
+	if      (compression_algorithm == "")     return -1;
+	else if (compression_algorithm == "zlib") algorithm = ROOT::RCompressionSetting::EAlgorithm::kZLIB;
+	else if (compression_algorithm == "lzma") algorithm = ROOT::RCompressionSetting::EAlgorithm::kLZMA;
+	else if (compression_algorithm == "lz4")  algorithm = ROOT::RCompressionSetting::EAlgorithm::kLZ4;
+	else if (compression_algorithm == "zstd") algorithm = ROOT::RCompressionSetting::EAlgorithm::kZSTD;
+	else
+	{
+		cerr << "Unknown compression algorithm \"" << compression_algorithm << "\". Use \"zlib\", \"lzma\", \"lz4\" or \"zstd\"\n";
+		abort();
+	}
+
+	return ROOT::CompressionSettings(algorithm, compression_level);
+}
+
+//Opens the output file with the chosen compression
+TFile* open_output_file(const char* path)
+{
+	int settings = output_compression_settings();
+	if (settings < 0)
+		return TFile::Open(path, "RECREATE");
+	return TFile::Open(path, "RECREATE", "", settings);
+}
+
+//Baskets of the tree are compressed in parallel when it is filled
+void enable_parallel_writing()
+{
+	if (write_threads != 1 && !ROOT::IsImplicitMTEnabled())
+		ROOT::EnableImplicitMT(write_threads);
+}
+
+//Basket and cluster sizes for a tree that is going to be filled. Call it after its branches are created
+void configure_output_tree(TTree* tree)
+{
+	tree->SetBasketSize("*", basket_size);
+	tree->SetAutoFlush(auto_flush);
+}
+
+//Text with the settings for printing
+string output_settings_description()
+{
+	string algorithm = (compression_algorithm == "") ? "ROOT default (source baskets on fast mode)" : compression_algorithm + " " + to_string(compression_level);
+	return algorithm + ", basket " + to_string(basket_size) + " B, auto flush " + to_string(auto_flush);
+}
+#endif
@@ -0,0 +1,325 @@
+#ifndef VARIATIONS_HEADER
+#define VARIATIONS_HEADER
+//Systematic variations of the fit, declared as a list and fitted for every bin
+//Fits of a bin run one after the other over the probes selected once for that bin, so a new variation only costs its fits
+//Bins are independent, so with variation_workers > 1 they are fitted by that many processes at the same time
+//Include it after the DoFit headers
+#include "ROOT/TProcessExecutor.hxx"
+#include "TObjString.h"
+#include "checkpoint.h"
+
+//Processes fitting bins at the same time, each one every variation of its bins. 1 fits every bin on this process
+//Processes do not share the fit state (ranges, warm start, last fit), so no fit has to be thread safe
+int variation_workers = 1;
+
+struct Variation
+{
+	string name;      //Name of its efficiency, like "MassUp"
+	string tag;       //Suffix of its histograms and prefix of its fit snapshots
+	string model;     //Key of fit_models (src/dofits/fit_models.h)
+	double mmin;      //Fit range
+	double mmax;
+	int    fit_bins;
+	string rule;      //"nominal" (only one), "error" adds its fit errors in quadrature, "shift" adds its difference to nominal in quadrature
+};
+
+//Variations of plot_sys_efficiency.cpp and plot_sys_efficiency_2d.cpp around the current fit_model, fit range and fit_bins
+//The macros call it after their settings are read, so the options of the executables change every variation. Add, remove or change lines here
+vector<Variation> make_variations()
+{
+	//A key of fit_models is a signal and a background suffix, like "GaussCB" + "_Chebychev"
+	//The signal variation is named after its model, "2xGauss" unless the nominal fit already uses it
+	size_t split          = fit_model.find('_');
+	string signal         = fit_model.substr(0, split);
+	string background     = (split == string::npos) ? "" : fit_model.substr(split);
+	string alt_signal     = (signal     == "2xGauss")    ? "GaussCB" : "2xGauss";
+	string alt_background = (background == "_Chebychev") ? ""        : "_Chebychev";
+	int    nbins          = (fit_bins > 0) ? fit_bins : 100;
+
+	return {
+		//name        tag          model                     fit range                    fit bins    rule
+		{"Nominal",  "nominal",  fit_model,                _mmin,        _mmax,        nbins,      "nominal"},
+		{alt_signal, alt_signal, alt_signal + background,  _mmin,        _mmax,        nbins,      "error"},
+		{"MassUp",   "MassUp",   fit_model,                _mmin - 0.05, _mmax + 0.05, nbins,      "error"},
+		{"MassDown", "MassDown", fit_model,                _mmin + 0.05, _mmax - 0.05, nbins,      "error"},
+		{"BinUp",    "BinUp",    fit_model,                _mmin,        _mmax,        nbins + 5,  "error"},
+		{"BinDown",  "BinDown",  fit_model,                _mmin,        _mmax,        nbins - 5,  "error"},
+		//Shape of the background, as the difference to the nominal fit
+		{"Background", "Background", signal + alt_background, _mmin, _mmax, nbins,      "shift"}
+	};
+}
+
+//Every array is [yield_all, yield_pass, err_all, err_pass], by bin
+struct VariationResults
+{
+	vector<vector<YieldsNErrs>> yields_n_errs;  //By variation, in the order of the list
+	vector<vector<FitInfo>>     fit_info;       //Same order, status -1 if the fit was not done by this process
+	vector<YieldsNErrs> systematic;             //Nominal yields with systematic errors
+	vector<YieldsNErrs> final;                  //Nominal yields with statistic and systematic errors
+	vector<ToyStudy>    toy_studies;            //Toys of the nominal fit of every bin, empty if toys_per_bin is 0
+};
+
+int nominal_variation(const vector<Variation>& variations)
+{
+	int nominal = -1;
+	for (size_t v = 0; v < variations.size(); v++)
+	{
+		if (fit_models.find(variations[v].model) == fit_models.end())
+		{
+			cerr << "Variation \"" << variations[v].name << "\" uses model \"" << variations[v].model << "\" that is not in fit_models\n";
+			abort();
+		}
+		if (variations[v].rule != "nominal" && variations[v].rule != "error" && variations[v].rule != "shift")
+		{
+			cerr << "Variation \"" << variations[v].name << "\" has unknown rule \"" << variations[v].rule << "\". Use \"nominal\", \"error\" or \"shift\"\n";
+			abort();
+		}
+		if (variations[v].rule == "nominal")
+		{
+			if (nominal >= 0)
+			{
+				cerr << "Only one variation can have rule \"nominal\"\n";
+				abort();
+			}
+			nominal = v;
+		}
+	}
+
+	if (nominal < 0)
+	{
+		cerr << "One variation needs rule \"nominal\"\n";
+		abort();
+	}
+	return nominal;
+}
+
+//Systematic and final uncertainties of every bin by the rules of each variation
+void combine_variations(const vector<Variation>& variations, VariationResults& results)
+{
+	int nominal = nominal_variation(variations);
+	int nbins   = results.yields_n_errs[nominal].size();
+	for (int i = 0; i < nbins; i++)
+	{
+		const YieldsNErrs& nominal_yields = results.yields_n_errs[nominal][i];
+		double systematic2[2] = {0., 0.};
+		for (int v = 0; v < (int)variations.size(); v++)
+		{
+			const YieldsNErrs& yields = results.yields_n_errs[v][i];
+			for (int k = 0; k < 2; k++)
+			{
+				if      (variations[v].rule == "error") systematic2[k] += pow(yields[k+2], 2);
+				else if (variations[v].rule == "shift") systematic2[k] += pow(yields[k] - nominal_yields[k], 2);
+			}
+		}
+
+		results.systematic.push_back({nominal_yields[0], nominal_yields[1], sqrt(systematic2[0]), sqrt(systematic2[1])});
+		results.final     .push_back({nominal_yields[0], nominal_yields[1],
+			sqrt(pow(nominal_yields[2], 2) + systematic2[0]), sqrt(pow(nominal_yields[3], 2) + systematic2[1])});
+	}
+}
+
+//Fits every variation of bin i: nominal first, then the others seeded by it (use_warm_start)
+//Every finished fit goes to the checkpoint journal. Fits already in checkpoint are read instead of fitted again
+//With toys_per_bin > 0 only the nominal fit makes toys. It is fitted even if it is in checkpoint, because toys need the model
+void fit_bin_variations(const vector<Variation>& variations, int i, const vector<string>& conditions, string MuonId, string savePath,
+	bool use_warm_start, Checkpoint& checkpoint, string checkpoint_path, VariationResults& results)
+{
+	int nominal = nominal_variation(variations);
+	vector<int> order = {nominal};
+	for (int v = 0; v < (int)variations.size(); v++)
+		if (v != nominal)
+			order.push_back(v);
+
+	warm_start_seed = NULL;
+	for (int v : order)
+	{
+		const Variation& variation = variations[v];
+		string key = checkpoint_key(variation.model, variation.mmin, variation.mmax, variation.fit_bins, conditions[i], MuonId);
+		bool make_toys = (toys_per_bin > 0 && v == nominal);
+		if (checkpoint.count(key) && !make_toys)
+		{
+			results.yields_n_errs[v][i] = checkpoint[key];
+			continue;
+		}
+
+		cout << variation.name << " calculation -----\n";
+
+		_mmin    = variation.mmin;
+		_mmax    = variation.mmax;
+		fit_bins = variation.fit_bins;
+		prefix_file_name = variation.tag + "_";
+		toys_on_this_fit = make_toys;
+		results.yields_n_errs[v][i] = fit_models[variation.model](conditions[i], MuonId, (savePath + prefix_file_name).c_str());
+		results.fit_info[v][i]      = last_fit_info;
+		if (make_toys)
+			results.toy_studies[i] = last_toy_study;
+		if (checkpoint_path != "" && !checkpoint.count(key))
+			append_checkpoint(checkpoint_path, key, results.yields_n_errs[v][i]);
+
+		if (v == nominal && use_warm_start)
+			warm_start_seed = (RooFitResult*)last_fit_result->Clone("nominal_fit_result");
+	}
+	delete warm_start_seed;
+	warm_start_seed  = NULL;
+	toys_on_this_fit = true;
+}
+
+//Results of every variation on bin i as text, one line by variation, to send them from a worker process
+string bin_results_text(const VariationResults& results, int i)
+{
+	string text;
+	for (size_t v = 0; v < results.yields_n_errs.size(); v++)
+	{
+		const YieldsNErrs& yields = results.yields_n_errs[v][i];
+		const FitInfo&     info   = results.fit_info[v][i];
+		char numbers[512];
+		snprintf(numbers, sizeof(numbers), "%.17g %.17g %.17g %.17g %d %.17g %d %.17g %d", yields[0], yields[1], yields[2], yields[3],
+			info.status, info.seconds, info.cov_quality, info.edm, info.refits);
+		text += string(numbers) + "\t" + info.strategy + "\t" + info.problems + "\n";
+	}
+
+	//Toys of the nominal fit: efficiency, error, interval and number of failed toys, then efficiency and pull of every toy
+	if (!results.toy_studies.empty())
+	{
+		const ToyStudy& study = results.toy_studies[i];
+		char numbers[512];
+		snprintf(numbers, sizeof(numbers), "%.17g %.17g %.17g %.17g %d %d", study.efficiency, study.error, study.low, study.high,
+			study.nfailed, (int)study.efficiencies.size());
+		text += numbers;
+		for (size_t toy = 0; toy < study.efficiencies.size(); toy++)
+		{
+			snprintf(numbers, sizeof(numbers), " %.17g %.17g", study.efficiencies[toy], study.pulls[toy]);
+			text += numbers;
+		}
+		text += "\t" + study.problem + "\n";
+	}
+	return text;
+}
+
+void read_bin_results(string text, VariationResults& results, int i)
+{
+	stringstream lines(text);
+	string line;
+	for (size_t v = 0; v < results.yields_n_errs.size(); v++)
+	{
+		YieldsNErrs& yields = results.yields_n_errs[v][i];
+		FitInfo&     info   = results.fit_info[v][i];
+		size_t first_tab  = string::npos;
+		size_t second_tab = string::npos;
+		if (getline(lines, line))
+		{
+			first_tab  = line.find('\t');
+			second_tab = line.find('\t', first_tab + 1);
+		}
+		if (second_tab == string::npos || sscanf(line.c_str(), "%lf %lf %lf %lf %d %lf %d %lf %d", &yields[0], &yields[1], &yields[2], &yields[3],
+			&info.status, &info.seconds, &info.cov_quality, &info.edm, &info.refits) != 9)
+		{
+			cerr << "Results of bin " << i << " from its worker process are not valid\n";
+			abort();
+		}
+		info.strategy = line.substr(first_tab + 1, second_tab - first_tab - 1);
+		info.problems = line.substr(second_tab + 1);
+	}
+
+	if (!results.toy_studies.empty())
+	{
+		ToyStudy& study = results.toy_studies[i];
+		int ntoys = -1;
+		if (getline(lines, line))
+		{
+			stringstream numbers(line.substr(0, line.find('\t')));
+			numbers >> study.efficiency >> study.error >> study.low >> study.high >> study.nfailed >> ntoys;
+			study.efficiencies.resize(max(ntoys, 0));
+			study.pulls       .resize(max(ntoys, 0));
+			for (int toy = 0; toy < ntoys; toy++)
+				numbers >> study.efficiencies[toy] >> study.pulls[toy];
+			if (!numbers)
+				ntoys = -1;
+		}
+		if (ntoys < 0 || line.find('\t') == string::npos)
+		{
+			cerr << "Toys of bin " << i << " from its worker process are not valid\n";
+			abort();
+		}
+		study.problem = line.substr(line.find('\t') + 1);
+	}
+}
+
+//Fits every variation on every bin. Conditions are the bins, savePath is the folder of the fit snapshots
+//Jobs of a bin are: nominal first, then the others seeded by it (use_warm_start). The probes of the bin are selected only on the first one
+//Bins do not depend on each other: with variation_workers > 1 each worker process fits every job of its bins
+//Every finished fit goes to the checkpoint journal. With resume, fits already there are read instead of fitted again
+VariationResults run_variations(const vector<Variation>& variations, const vector<string>& conditions, string MuonId, string savePath, bool use_warm_start,
+	string checkpoint_path = "", bool resume = false)
+{
+	nominal_variation(variations);
+	int nbins = conditions.size();
+
+	cout << "Systematic variations: " << nbins << " bins x " << variations.size() << " variations = " << nbins*variations.size() << " fits\n";
+
+	Checkpoint checkpoint;
+	if (checkpoint_path != "")
+	{
+		if (resume)
+			checkpoint = read_checkpoint(checkpoint_path);
+		else
+			remove(checkpoint_path.c_str());
+		cout << "Checkpoint: \"" << checkpoint_path << "\" (" << checkpoint.size() << " fits to resume)\n";
+	}
+
+	int nresumed = 0;
+	for (int i = 0; i < nbins; i++)
+		for (const Variation& variation : variations)
+			nresumed += checkpoint.count(checkpoint_key(variation.model, variation.mmin, variation.mmax, variation.fit_bins, conditions[i], MuonId));
+
+	const double default_min  = _mmin;
+	const double default_max  = _mmax;
+	const int    default_bins = fit_bins;
+
+	VariationResults results;
+	results.yields_n_errs.assign(variations.size(), vector<YieldsNErrs>(nbins));
+	results.fit_info     .assign(variations.size(), vector<FitInfo>(nbins, {-1, 0.}));
+	if (toys_per_bin > 0)
+		results.toy_studies.assign(nbins, ToyStudy());
+	int nworkers = min(variation_workers, nbins);
+	if (nworkers > 1)
+	{
+		//Probes are loaded before the processes are forked, so they share them
+		load_probe_dataset(data_file_path);
+		cout << "Fitting the bins on " << nworkers << " worker processes\n";
+
+		ROOT::TProcessExecutor pool(nworkers);
+		auto texts = pool.Map([&](int i)
+		{
+			//The threads of the data pool are not copied to a forked process
+			data_threads = 1;
+			fit_bin_variations(variations, i, conditions, MuonId, savePath, use_warm_start, checkpoint, checkpoint_path, results);
+			return new TObjString(bin_results_text(results, i).c_str());
+		}, ROOT::TSeqI(nbins));
+
+		for (int i = 0; i < nbins; i++)
+		{
+			read_bin_results(texts[i]->GetString().Data(), results, i);
+			if (toys_per_bin > 0)
+				results.toy_studies[i].condition = conditions[i];
+			delete texts[i];
+		}
+	}
+	else for (int i = 0; i < nbins; i++)
+		fit_bin_variations(variations, i, conditions, MuonId, savePath, use_warm_start, checkpoint, checkpoint_path, results);
+
+	_mmin    = default_min;
+	_mmax    = default_max;
+	fit_bins = default_bins;
+	prefix_file_name = "";
+
+	if (nresumed > 0)
+		cout << nresumed << " fits read from the checkpoint, " << nbins*variations.size() - nresumed << " fitted\n";
+	if ((int)checkpoint.size() > nresumed)
+		cout << "Warning: " << checkpoint.size() - nresumed << " fits of the checkpoint do not match this run (data files, selection or fit settings"
+			<< " changed) and were not used\n";
+
+	combine_variations(variations, results);
+	return results;
+}
+#endif
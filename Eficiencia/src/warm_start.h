@@ -0,0 +1,106 @@
+#ifndef WARM_START_HEADER
+#define WARM_START_HEADER
+//Copy of the last fit made by doFit, so it can be used as seed for the next fits
+RooFitResult* last_fit_result = NULL;
+
+//If it is not NULL, doFit starts Minuit from these values instead of the hard-coded ones
+RooFitResult* warm_start_seed = NULL;
+
+//Parameters that have different names depending on the signal model
+const char* warm_start_aliases[][2] = {
+	{"sigma_gs", "sigma1"},
+	{"sigma_gs", "sigma_dscb"}
+};
+
+//Finds the parameter in the seed by its name or by its alias
+RooRealVar* find_seed_parameter(const RooFitResult* seed, string name)
+{
+	RooRealVar* seed_par = (RooRealVar*)seed->floatParsFinal().find(name.c_str());
+	if (seed_par != NULL)
+		return seed_par;
+
+	for (auto& alias : warm_start_aliases)
+	{
+		if      (name == alias[0]) seed_par = (RooRealVar*)seed->floatParsFinal().find(alias[1]);
+		else if (name == alias[1]) seed_par = (RooRealVar*)seed->floatParsFinal().find(alias[0]);
+
+		if (seed_par != NULL)
+			return seed_par;
+	}
+
+	return NULL;
+}
+
+//Sets value and step size (error from the seed covariance) of every floating parameter found in the seed
+//Returns how many parameters were seeded
+int apply_warm_start(RooArgSet* params, const RooFitResult* seed)
+{
+	int nseeded = 0;
+	for (RooAbsArg* arg : *params)
+	{
+		RooRealVar* par = dynamic_cast<RooRealVar*>(arg);
+		if (par == NULL || par->isConstant())
+			continue;
+
+		RooRealVar* seed_par = find_seed_parameter(seed, par->GetName());
+		if (seed_par == NULL)
+			continue;
+
+		//Yields limits depend on the fit range, so the seed may not fit in this one
+		if (seed_par->getVal() <= par->getMin() || seed_par->getVal() >= par->getMax())
+			continue;
+
+		par->setVal(seed_par->getVal());
+		if (seed_par->getError() > 0.)
+			par->setError(seed_par->getError());
+		nseeded++;
+	}
+
+	cout << "Warm start: " << nseeded << " parameters seeded from \"" << seed->GetName() << "\"\n";
+	return nseeded;
+}
+
+//Sets back values and errors stored in a snapshot
+void restore_parameters(RooArgSet* params, const RooArgSet* snapshot)
+{
+	for (RooAbsArg* arg : *params)
+	{
+		RooRealVar* par      = dynamic_cast<RooRealVar*>(arg);
+		RooRealVar* snap_par = (RooRealVar*)snapshot->find(arg->GetName());
+		if (par == NULL || snap_par == NULL)
+			continue;
+
+		par->setVal  (snap_par->getVal());
+		par->setError(snap_par->getError());
+	}
+}
+
+//Fits with warm start if there is a seed, and falls back to cold start if it does not converge
+RooFitResult* fit_with_warm_start(RooSimultaneous& simPdf, RooDataHist& combData, string model_name)
+{
+	RooArgSet* params     = simPdf.getParameters(combData);
+	RooArgSet* cold_start = (RooArgSet*)params->snapshot();
+
+	if (warm_start_seed != NULL)
+		apply_warm_start(params, warm_start_seed);
+
+	RooFitResult* fitres = run_fit(simPdf, combData, model_name);
+
+	if (warm_start_seed != NULL && fitres->status() != 0)
+	{
+		cout << "Warm start did not converge (status " << fitres->status() << "). Fitting again with cold start\n";
+		delete fitres;
+		restore_parameters(params, cold_start);
+		fitres = run_fit(simPdf, combData, model_name);
+	}
+
+	//Keeps a copy to be used as seed later
+	delete last_fit_result;
+	last_fit_result = (RooFitResult*)fitres->Clone("last_fit_result");
+
+	delete cold_start;
+	delete params;
+
+	return fitres;
+}
+#endif
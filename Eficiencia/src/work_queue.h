@@ -0,0 +1,440 @@
+#ifndef WORK_QUEUE_HEADER
+#define WORK_QUEUE_HEADER
+//Fits of a grid shared by processes on any number of hosts through a folder on a shared filesystem. No other service is needed
+//<queue>/queue.txt         number of tasks. It is written last, so workers only start on a complete queue
+//<queue>/tasks/<id>.txt    one fit: dataset, model, fit range, fit bins, data, tag cut, Muon Id, bin condition and where to save its snapshot
+//<queue>/claims/<id>.txt   created with O_EXCL by the worker that runs the task, with its host and pid. Its modification time
+//                          is refreshed while the task runs, so a claim that is not refreshed belongs to a dead worker
+//<queue>/done/<id>.txt     yields and errors of the fit, renamed in place when complete
+//Ages of claims are compared with the modification time of a probe file written in <queue>, so only the clock of the file server counts
+//queue_worker.cpp runs tasks of a queue. run_variations_on_queue writes the tasks, runs tasks too and assembles the results
+#include "variations.h"
+#include <fstream>
+#include <sstream>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <fcntl.h>
+#include <utime.h>
+#include <sys/stat.h>
+
+//Seconds between checks of the coordinator while other workers end their tasks
+int queue_poll_seconds = 10;
+
+//Seconds between refreshes of the claim of the running task
+int claim_heartbeat_seconds = 60;
+
+//A claim not refreshed for this many seconds is taken as a dead worker and its task is released. 0 never releases
+int claim_timeout = 600;
+
+//The coordinator gives up when no task ends for this many seconds, and reports the tasks that are still claimed. 0 waits forever
+int queue_give_up_seconds = 4*3600;
+
+struct FitTask
+{
+	string dataset;    //output_folder_name of the run that submitted it
+	string model;
+	double mmin;
+	double mmax;
+	int    fit_bins;
+	string data_file;
+	string tag_cut;
+	string MuonId;
+	string condition;
+	string save_path;
+};
+
+//Path of a task in one of the folders of the queue
+string queue_file(string queue, string folder, int id)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "%06d.txt", id);
+	return queue + folder + "/" + name;
+}
+
+bool queue_file_exists(string path)
+{
+	return !gSystem->AccessPathName(path.c_str());
+}
+
+//Content of a file or "" if it does not exist
+string read_text(string path)
+{
+	ifstream file(path);
+	stringstream text;
+	text << file.rdbuf();
+	return text.str();
+}
+
+//Writes on a temporary file and renames it, so readers never see a file half written
+void write_text_atomic(string path, string text)
+{
+	string tmp_path = path + "." + gSystem->HostName() + "." + to_string(gSystem->GetPid()) + ".tmp";
+	FILE* file = fopen(tmp_path.c_str(), "w");
+	if (file == NULL)
+	{
+		cerr << "Could not write \"" << tmp_path << "\"\n";
+		abort();
+	}
+	fputs(text.c_str(), file);
+	fflush(file);
+	fsync(fileno(file));
+	fclose(file);
+
+	if (rename(tmp_path.c_str(), path.c_str()) != 0)
+	{
+		cerr << "Could not rename \"" << tmp_path << "\" to \"" << path << "\"\n";
+		abort();
+	}
+}
+
+string task_text(const FitTask& task)
+{
+	char range[128];
+	snprintf(range, sizeof(range), "%.17g %.17g", task.mmin, task.mmax);
+	return "dataset "   + task.dataset                + "\n" +
+	       "model "     + task.model                  + "\n" +
+	       "range "     + range                       + "\n" +
+	       "fit_bins "  + to_string(task.fit_bins)    + "\n" +
+	       "data_file " + task.data_file              + "\n" +
+	       "tag_cut "   + task.tag_cut                + "\n" +
+	       "MuonId "    + task.MuonId                 + "\n" +
+	       "condition " + task.condition              + "\n" +
+	       "save_path " + task.save_path              + "\n";
+}
+
+FitTask parse_task(string text, string path)
+{
+	map<string, string> fields;
+	stringstream lines(text);
+	string line;
+	while (getline(lines, line))
+	{
+		size_t space = line.find(' ');
+		if (space != string::npos)
+			fields[line.substr(0, space)] = line.substr(space + 1);
+	}
+
+	for (const char* name : {"dataset", "model", "range", "fit_bins", "data_file", "tag_cut", "MuonId", "condition", "save_path"})
+		if (fields.find(name) == fields.end())
+		{
+			cerr << "Task \"" << path << "\" has no " << name << "\n";
+			abort();
+		}
+
+	FitTask task;
+	task.dataset   = fields["dataset"];
+	task.model     = fields["model"];
+	sscanf(fields["range"].c_str(), "%lf %lf", &task.mmin, &task.mmax);
+	task.fit_bins  = atoi(fields["fit_bins"].c_str());
+	task.data_file = fields["data_file"];
+	task.tag_cut   = fields["tag_cut"];
+	task.MuonId    = fields["MuonId"];
+	task.condition = fields["condition"];
+	task.save_path = fields["save_path"];
+	return task;
+}
+
+//Number of tasks of the queue or 0 if it was not submitted yet
+int queue_size(string queue)
+{
+	return atoi(read_text(queue + "queue.txt").c_str());
+}
+
+//Writes the tasks. A queue that already exists is reused only if it has the same tasks, so results already done are kept
+void submit_tasks(string queue, const vector<FitTask>& tasks)
+{
+	for (string folder : {"", "tasks/", "claims/", "done/"})
+		if (gSystem->AccessPathName((queue + folder).c_str()) && gSystem->mkdir((queue + folder).c_str(), true))
+		{
+			cerr << "\"" << queue + folder << "\" queue folder could not be created\n";
+			abort();
+		}
+
+	int ntasks = queue_size(queue);
+	if (ntasks > 0)
+	{
+		bool same_tasks = (ntasks == (int)tasks.size());
+		for (int id = 0; same_tasks && id < ntasks; id++)
+			same_tasks = (read_text(queue_file(queue, "tasks", id)) == task_text(tasks[id]));
+
+		if (!same_tasks)
+		{
+			cerr << "Queue \"" << queue << "\" has other tasks. Remove it or use another queue\n";
+			abort();
+		}
+		cout << "Queue \"" << queue << "\" already submitted, reusing it\n";
+		return;
+	}
+
+	for (int id = 0; id < (int)tasks.size(); id++)
+		write_text_atomic(queue_file(queue, "tasks", id), task_text(tasks[id]));
+	write_text_atomic(queue + "queue.txt", to_string(tasks.size()) + "\n");
+	cout << "Queue \"" << queue << "\" submitted with " << tasks.size() << " tasks\n";
+}
+
+//Only one process can create the claim of a task
+bool claim_task(string queue, int id)
+{
+	int fd = open(queue_file(queue, "claims", id).c_str(), O_CREAT | O_EXCL | O_WRONLY, 0644);
+	if (fd < 0)
+		return false;
+
+	string owner = string(gSystem->HostName()) + " " + to_string(gSystem->GetPid()) + "\n";
+	if (write(fd, owner.data(), owner.size()) < 0)
+		cerr << "Could not write the owner of task " << id << "\n";
+	close(fd);
+	return true;
+}
+
+//Current time on the clock of the filesystem of the queue, which also sets the modification time of the claims
+//Ages of claims are measured with it and not with time(NULL), so a host with a skewed clock does not release live claims
+time_t queue_clock(string queue)
+{
+	string probe_path = queue + "clock." + gSystem->HostName() + "." + to_string(gSystem->GetPid());
+	FILE* probe = fopen(probe_path.c_str(), "w");
+	if (probe == NULL)
+	{
+		cerr << "Could not write \"" << probe_path << "\"\n";
+		abort();
+	}
+	fclose(probe);
+	utime(probe_path.c_str(), NULL);
+
+	struct stat probe_stat;
+	int failed = stat(probe_path.c_str(), &probe_stat);
+	remove(probe_path.c_str());
+	if (failed != 0)
+	{
+		cerr << "Could not read the modification time of \"" << probe_path << "\"\n";
+		abort();
+	}
+	return probe_stat.st_mtime;
+}
+
+//Removes claims not refreshed for claim_timeout of tasks without result, so another worker takes them
+int release_stale_claims(string queue, int ntasks)
+{
+	if (claim_timeout <= 0)
+		return 0;
+
+	time_t now = queue_clock(queue);
+	int nreleased = 0;
+	for (int id = 0; id < ntasks; id++)
+	{
+		struct stat claim;
+		string claim_path = queue_file(queue, "claims", id);
+		if (queue_file_exists(queue_file(queue, "done", id)) || stat(claim_path.c_str(), &claim) != 0)
+			continue;
+
+		string owner = read_text(claim_path);
+		if (now - claim.st_mtime > claim_timeout && remove(claim_path.c_str()) == 0)
+		{
+			cout << "Task " << id << " released, claimed by " << owner << "more than " << claim_timeout << "s ago\n";
+			nreleased++;
+		}
+	}
+	return nreleased;
+}
+
+//Fits a task with its own dataset, data, tag cut and fit settings
+//The dataset sets output_folder_name, so the fast fit validation is the one of the submitter whatever DoFit header the worker includes
+YieldsNErrs run_task(const FitTask& task)
+{
+	if (fit_models.find(task.model) == fit_models.end())
+	{
+		cerr << "Task uses model \"" << task.model << "\" that is not in fit_models\n";
+		abort();
+	}
+
+	//output_folder_name, data_file_path and tag_cut point to these while the task runs
+	static string task_dataset, task_data_file, task_tag_cut;
+	task_dataset   = task.dataset;
+	task_data_file = task.data_file;
+	task_tag_cut   = task.tag_cut;
+
+	const char*  default_dataset   = output_folder_name;
+	const char*  default_data_file = data_file_path;
+	const char*  default_tag_cut   = tag_cut;
+	const double default_min       = _mmin;
+	const double default_max       = _mmax;
+	const int    default_bins      = fit_bins;
+
+	//Tasks only give yields, so they make no toys
+	output_folder_name = task_dataset.c_str();
+	data_file_path     = task_data_file.c_str();
+	tag_cut            = task_tag_cut.c_str();
+	_mmin              = task.mmin;
+	_mmax              = task.mmax;
+	fit_bins           = task.fit_bins;
+	toys_on_this_fit   = false;
+	YieldsNErrs yields_n_errs = fit_models[task.model](task.condition, task.MuonId, task.save_path.c_str());
+
+	output_folder_name = default_dataset;
+	data_file_path     = default_data_file;
+	tag_cut            = default_tag_cut;
+	_mmin              = default_min;
+	_mmax              = default_max;
+	fit_bins           = default_bins;
+	toys_on_this_fit   = true;
+	return yields_n_errs;
+}
+
+//Runs a task and refreshes its claim from another thread meanwhile
+YieldsNErrs run_claimed_task(const FitTask& task, string claim_path)
+{
+	atomic<bool> running(true);
+	thread heartbeat([&]()
+	{
+		int waited = 0;
+		while (running)
+		{
+			this_thread::sleep_for(chrono::seconds(1));
+			if (++waited >= claim_heartbeat_seconds)
+			{
+				utime(claim_path.c_str(), NULL);
+				waited = 0;
+			}
+		}
+	});
+
+	YieldsNErrs yields_n_errs = run_task(task);
+	running = false;
+	heartbeat.join();
+	return yields_n_errs;
+}
+
+//Runs every task of the queue that is not done nor claimed by someone else. Returns how many it ran
+int work_on_queue(string queue)
+{
+	int ntasks = queue_size(queue);
+	if (ntasks == 0)
+	{
+		cout << "Queue \"" << queue << "\" was not submitted yet\n";
+		return 0;
+	}
+
+	int nrun = 0;
+	for (int id = 0; id < ntasks; id++)
+	{
+		string done_path = queue_file(queue, "done", id);
+		if (queue_file_exists(done_path) || !claim_task(queue, id))
+			continue;
+
+		//It may have been done by a worker whose claim was released
+		if (queue_file_exists(done_path))
+			continue;
+
+		string task_path = queue_file(queue, "tasks", id);
+		cout << "Task " << id << " of " << ntasks << " -----\n";
+		YieldsNErrs yields_n_errs = run_claimed_task(parse_task(read_text(task_path), task_path), queue_file(queue, "claims", id));
+
+		char result[256];
+		snprintf(result, sizeof(result), "%.17g %.17g %.17g %.17g\n", yields_n_errs[0], yields_n_errs[1], yields_n_errs[2], yields_n_errs[3]);
+		write_text_atomic(done_path, result);
+		nrun++;
+	}
+	return nrun;
+}
+
+//Prints the tasks without result: who claimed them and when their claim was refreshed
+void report_pending_tasks(string queue, int ntasks)
+{
+	time_t now = queue_clock(queue);
+	for (int id = 0; id < ntasks; id++)
+	{
+		struct stat claim;
+		string claim_path = queue_file(queue, "claims", id);
+		if (queue_file_exists(queue_file(queue, "done", id)))
+			continue;
+
+		if (stat(claim_path.c_str(), &claim) != 0)
+			cerr << "  Task " << id << ": not claimed\n";
+		else
+		{
+			string owner = read_text(claim_path);
+			if (!owner.empty() && owner.back() == '\n')
+				owner.pop_back();
+			cerr << "  Task " << id << ": claimed by " << owner << ", refreshed " << now - claim.st_mtime << "s ago\n";
+		}
+	}
+}
+
+int count_done(string queue, int ntasks)
+{
+	int ndone = 0;
+	for (int id = 0; id < ntasks; id++)
+		ndone += queue_file_exists(queue_file(queue, "done", id));
+	return ndone;
+}
+
+//Same results as run_variations, but every fit is a task of the queue. The task of variation v on bin i is i*nvariations + v
+//This process works on the queue too, and waits for the tasks claimed by other workers before assembling
+//Each task starts cold, without warm start from the nominal fit of its bin
+VariationResults run_variations_on_queue(const vector<Variation>& variations, const vector<string>& conditions, string MuonId, string savePath, string queue)
+{
+	nominal_variation(variations);
+	int nvariations = variations.size();
+	int nbins       = conditions.size();
+
+	//Results of the tasks are only their yields
+	if (toys_per_bin > 0)
+		cout << "Toys are not made on queue mode. Run efficiency.cpp or a local run for them\n";
+
+	vector<FitTask> tasks;
+	for (int i = 0; i < nbins; i++)
+		for (const Variation& variation : variations)
+			tasks.push_back({output_folder_name, variation.model, variation.mmin, variation.mmax, variation.fit_bins, data_file_path, tag_cut,
+				MuonId, conditions[i], savePath + variation.tag + "_"});
+	submit_tasks(queue, tasks);
+	cout << "More workers can join with: root -l -b -q 'queue_worker.cpp(\"" << queue << "\")'\n";
+
+	int    ntasks        = tasks.size();
+	int    ndone         = 0;
+	int    last_ndone    = -1;
+	time_t last_progress = time(NULL);
+	while (true)
+	{
+		work_on_queue(queue);
+		ndone = count_done(queue, ntasks);
+		if (ndone == ntasks)
+			break;
+
+		if (ndone > last_ndone)
+		{
+			last_ndone    = ndone;
+			last_progress = time(NULL);
+		}
+		else if (queue_give_up_seconds > 0 && time(NULL) - last_progress > queue_give_up_seconds)
+		{
+			cerr << "No task of queue \"" << queue << "\" ended in the last " << queue_give_up_seconds << "s. Tasks without result:\n";
+			report_pending_tasks(queue, ntasks);
+			cerr << "Finish them with queue_worker.cpp or remove their claims, then run again to reuse the queue\n";
+			abort();
+		}
+
+		//Tasks released here are taken on the next pass
+		release_stale_claims(queue, ntasks);
+		cout << "Queue: " << ndone << " of " << ntasks << " tasks done, waiting for other workers\n";
+		gSystem->Sleep(queue_poll_seconds*1000);
+	}
+
+	VariationResults results;
+	results.yields_n_errs.assign(nvariations, vector<YieldsNErrs>(nbins));
+	results.fit_info     .assign(nvariations, vector<FitInfo>(nbins, {-1, 0.}));
+	for (int i = 0; i < nbins; i++)
+		for (int v = 0; v < nvariations; v++)
+		{
+			string done_path = queue_file(queue, "done", i*nvariations + v);
+			YieldsNErrs& yields_n_errs = results.yields_n_errs[v][i];
+			if (sscanf(read_text(done_path).c_str(), "%lf %lf %lf %lf", &yields_n_errs[0], &yields_n_errs[1], &yields_n_errs[2], &yields_n_errs[3]) != 4)
+			{
+				cerr << "Result \"" << done_path << "\" is not valid\n";
+				abort();
+			}
+		}
+
+	combine_variations(variations, results);
+	return results;
+}
+#endif
@@ -0,0 +1,100 @@
+//Compares the fast backend (src/fast_binned_fit.h) with RooFit on the same bins
+//Writes the comparison of every bin to the validation record of the dataset (src/fit_backend.h). The fast backend
+//is only used in production for the models this record lists as validated
+//Usage: root -l -b -q validate_fast_fit.cpp
+//Change if you need
+//#include "src/dofits/DoFit_Jpsi_Run.h"
+#include "src/dofits/DoFit_Jpsi_MC.h"
+
+#include "src/create_folder.h"
+
+string MuonId   = "trackerMuon";
+string quantity = "Pt";     double bins[] = {0., 3.0, 3.6, 4.0, 4.4, 4.7, 5.0, 5.6, 5.8, 6.0, 6.2, 6.4, 6.6, 6.8, 7.3, 9.5, 13.0, 17.0, 40.};
+
+//Maximum accepted difference between backends, in units of the RooFit error
+double tolerance = 0.1;
+
+void validate_fast_fit()
+{
+	RooMsgService::instance().setGlobalKillBelow(RooFit::WARNING);
+
+	//Every fit has to be done here, without cache, without plots and with both backends
+	use_fit_cache = false;
+	fit_plot_mode = "none";
+	fit_bins = 100;
+	require_fast_validation = false;
+
+	//Data is read once before timing, so the first backend does not pay for it
+	load_probe_dataset(data_file_path);
+
+	create_folder(fast_validation_folder.c_str());
+	ofstream record(fast_validation_path());
+	record << "#validate_fast_fit.cpp on " << output_folder_name << " (" << data_file_path << "), " << MuonId << " by " << quantity
+		<< ", tolerance " << tolerance << " RooFit errors\n";
+	record << "#model condition all_roofit all_fast pass_roofit pass_fast diff_all/err diff_pass/err eff_roofit eff_fast eff_diff time_roofit time_fast\n";
+
+	int nbins = sizeof(bins)/sizeof(*bins) - 1;
+	const char* model_names[] = {"GaussCB", "2xGauss"};
+	for (int model = 0; model < 2; model++)
+	{
+		int nfailed = 0;
+		double time_roofit = 0.;
+		double time_fast   = 0.;
+		double max_eff_diff = 0.;
+
+		for (int i = 0; i < nbins; i++)
+		{
+			string conditions = string(    "ProbeMuon_" + quantity + ">=" + to_string(bins[i]  ));
+			conditions +=       string(" && ProbeMuon_" + quantity + "< " + to_string(bins[i+1]));
+
+			YieldsNErrs yields_n_errs[2];
+			double  fit_time[2];
+			const char* backends[] = {"roofit", "fast"};
+			for (int b = 0; b < 2; b++)
+			{
+				fit_backend = backends[b];
+				TStopwatch watch;
+				yields_n_errs[b] = fit_models[model_names[model]](conditions, MuonId, NULL);
+				fit_time[b] = watch.RealTime();
+			}
+			time_roofit += fit_time[0];
+			time_fast   += fit_time[1];
+
+			//Difference of the yields in units of the RooFit error, and of the efficiencies
+			double diff_all   = fabs(yields_n_errs[1][0] - yields_n_errs[0][0])/yields_n_errs[0][2];
+			double diff_pass  = fabs(yields_n_errs[1][1] - yields_n_errs[0][1])/yields_n_errs[0][3];
+			double eff_roofit = yields_n_errs[0][1]/yields_n_errs[0][0];
+			double eff_fast   = yields_n_errs[1][1]/yields_n_errs[1][0];
+			bool   agree      = (diff_all < tolerance && diff_pass < tolerance);
+			if (!agree)
+				nfailed++;
+			max_eff_diff = max(max_eff_diff, fabs(eff_fast - eff_roofit));
+
+			printf("%-8s %-40s all: %10.1f %10.1f pass: %10.1f %10.1f  diff/err: %.3f %.3f  eff: %.5f %.5f  time: %.2fs %.3fs %s\n",
+				model_names[model], conditions.c_str(),
+				yields_n_errs[0][0], yields_n_errs[1][0], yields_n_errs[0][1], yields_n_errs[1][1],
+				diff_all, diff_pass, eff_roofit, eff_fast, fit_time[0], fit_time[1], agree ? "" : "<- DISAGREE");
+			record << model_names[model] << " \"" << conditions << "\" " << yields_n_errs[0][0] << " " << yields_n_errs[1][0] << " "
+				<< yields_n_errs[0][1] << " " << yields_n_errs[1][1] << " " << diff_all << " " << diff_pass << " "
+				<< eff_roofit << " " << eff_fast << " " << eff_fast - eff_roofit << " " << fit_time[0] << " " << fit_time[1] << "\n";
+		}
+
+		record << "#" << model_names[model] << ": RooFit " << time_roofit << "s, fast " << time_fast << "s, largest efficiency difference "
+			<< max_eff_diff << ", " << nfailed << " bins outside tolerance\n";
+		if (nfailed == 0)
+			record << "validated " << model_names[model] << "\n";
+
+		cout << "\n------------------------\n";
+		cout << model_names[model] << "\n";
+		cout << "Total time RooFit: " << time_roofit << "s\n";
+		cout << "Total time fast:   " << time_fast   << "s\n";
+		cout << "Largest efficiency difference: " << max_eff_diff << "\n";
+		cout << "Bins outside tolerance (" << tolerance << " sigma): " << nfailed << (nfailed == 0 ? " (validated)" : " (not validated)");
+		cout << "\n------------------------\n";
+	}
+
+	fit_backend = "roofit";
+	require_fast_validation = true;
+
+	cout << "Validation record: " << fast_validation_path() << "\n";
+}